@@ -0,0 +1,213 @@
+/*
+  ==============================================================================
+    ConvolutionWorkerPool.cpp
+    Created: 17 Oct 2026
+  ==============================================================================
+*/
+
+#include "ConvolutionWorkerPool.h"
+
+#if JUCE_MAC || JUCE_IOS
+ #include <dispatch/dispatch.h>
+#elif JUCE_LINUX || JUCE_BSD || JUCE_ANDROID
+ #include <semaphore.h>
+ #include <cerrno>
+ #include <ctime>
+#endif
+
+class ConvolutionWorkerPool::Semaphore
+{
+public:
+   #if JUCE_MAC || JUCE_IOS
+    Semaphore() : semaphore(dispatch_semaphore_create(0)) {}
+    ~Semaphore() { dispatch_release(semaphore); }
+
+    void post() noexcept { dispatch_semaphore_signal(semaphore); }
+
+    void wait(int timeoutMs) noexcept
+    {
+        dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, (int64_t) timeoutMs * (int64_t) NSEC_PER_MSEC));
+    }
+
+   private:
+    dispatch_semaphore_t semaphore;
+   #elif JUCE_LINUX || JUCE_BSD || JUCE_ANDROID
+    Semaphore() { sem_init(&semaphore, 0, 0); }
+    ~Semaphore() { sem_destroy(&semaphore); }
+
+    void post() noexcept { sem_post(&semaphore); }
+
+    void wait(int timeoutMs) noexcept
+    {
+        timespec until;
+        clock_gettime(CLOCK_REALTIME, &until);
+        until.tv_sec += timeoutMs / 1000;
+        until.tv_nsec += (long) (timeoutMs % 1000) * 1000000;
+
+        if (until.tv_nsec >= 1000000000)
+        {
+            until.tv_nsec -= 1000000000;
+            ++until.tv_sec;
+        }
+
+        while (sem_timedwait(&semaphore, &until) != 0 && errno == EINTR) {}
+    }
+
+   private:
+    sem_t semaphore;
+   #else
+    // anywhere else, a sleeping worker just checks back every millisecond -- the timeout is
+    // ignored, and so is post().
+    Semaphore() = default;
+
+    void post() noexcept {}
+    void wait(int) noexcept { juce::Thread::sleep(1); }
+   #endif
+
+    JUCE_DECLARE_NON_COPYABLE (Semaphore)
+};
+
+class ConvolutionWorkerPool::Worker : public juce::Thread
+{
+public:
+    explicit Worker(ConvolutionWorkerPool& p)
+        : juce::Thread("Convolution Worker"), pool(p)
+    {
+    }
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            if (auto* task = pool.claimNextTask())
+            {
+                runTask(*task);
+                continue;
+            }
+
+            // say we're going to sleep before looking at the queue one last time. a submit()
+            // that got in before our look is picked up by it, and one that got in after will
+            // see us counted, and post.
+            pool.numSleeping.fetch_add(1);
+
+            if (auto* task = pool.claimNextTask())
+            {
+                pool.numSleeping.fetch_sub(1);
+                runTask(*task);
+                continue;
+            }
+
+            // the timeout is just a safety net -- submit() wakes us up.
+            pool.workAvailable->wait(10);
+            pool.numSleeping.fetch_sub(1);
+        }
+    }
+
+private:
+    static void runTask(Task& task) noexcept
+    {
+        task.run();
+        task.state.store(Task::finished, std::memory_order_release);
+    }
+
+    ConvolutionWorkerPool& pool;
+};
+
+ConvolutionWorkerPool::ConvolutionWorkerPool()
+    : workAvailable(std::make_unique<Semaphore>())
+{
+    // leave a core for the host's own audio thread.
+    const int numWorkers = juce::jlimit(1, 8, juce::SystemStats::getNumCpus() - 1);
+
+    for (int i = 0; i < numWorkers; ++i)
+        workers.add(new Worker(*this))->startThread(juce::Thread::Priority::highest);
+}
+
+ConvolutionWorkerPool::~ConvolutionWorkerPool()
+{
+    for (auto* worker : workers)
+    {
+        worker->signalThreadShouldExit();
+        workAvailable->post();
+    }
+
+    for (auto* worker : workers)
+        worker->stopThread(2000);
+}
+
+bool ConvolutionWorkerPool::submit(Task& task, double deadline) noexcept
+{
+    {
+        const juce::SpinLock::ScopedLockType sl(queueLock);
+
+        if (queueSize == queueCapacity)
+            return false;
+
+        task.state.store(Task::queued, std::memory_order_release);
+        queue[(size_t) queueSize++] = { deadline, &task };
+        std::push_heap(queue.begin(), queue.begin() + queueSize);
+    }
+
+    // a worker that's awake will get to it without being told. if they're all busy, this is
+    // the whole cost of handing it over.
+    if (numSleeping.load() > 0)
+        workAvailable->post();
+
+    return true;
+}
+
+ConvolutionWorkerPool::Task* ConvolutionWorkerPool::claimNextTask() noexcept
+{
+    const juce::SpinLock::ScopedLockType sl(queueLock);
+
+    // the claim happens under the lock, so cancel() can never see a task as queued after a
+    // worker has grabbed it.
+    while (queueSize > 0)
+    {
+        std::pop_heap(queue.begin(), queue.begin() + queueSize);
+        auto* task = queue[(size_t) --queueSize].task;
+
+        int expected = Task::queued;
+        if (task->state.compare_exchange_strong(expected, Task::running, std::memory_order_acq_rel))
+            return task;
+    }
+
+    return nullptr;
+}
+
+void ConvolutionWorkerPool::complete(Task& task) noexcept
+{
+    int expected = Task::queued;
+    if (task.state.compare_exchange_strong(expected, Task::running, std::memory_order_acq_rel))
+    {
+        task.run();
+    }
+    else
+    {
+        // a worker's partway through it. it can't be handed back, so this waits out the rest of
+        // that one run, and no more (see the header).
+        while (task.state.load(std::memory_order_acquire) == Task::running)
+            juce::Thread::yield();
+    }
+
+    task.state.store(Task::idle, std::memory_order_release);
+}
+
+void ConvolutionWorkerPool::cancel(Task& task)
+{
+    {
+        const juce::SpinLock::ScopedLockType sl(queueLock);
+
+        auto end = std::remove_if(queue.begin(), queue.begin() + queueSize, [&task](const Entry& e) { return e.task == &task; });
+        queueSize = (int) (end - queue.begin());
+        std::make_heap(queue.begin(), queue.begin() + queueSize);
+
+        int expected = Task::queued;
+        task.state.compare_exchange_strong(expected, Task::idle, std::memory_order_acq_rel);
+    }
+
+    while (task.state.load(std::memory_order_acquire) == Task::running)
+        juce::Thread::yield();
+
+    task.state.store(Task::idle, std::memory_order_release);
+}
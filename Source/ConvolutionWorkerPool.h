@@ -0,0 +1,98 @@
+/*
+  ==============================================================================
+    ConvolutionWorkerPool.h
+    Created: 17 Oct 2026
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// a handful of high-priority threads, shared by every SilkGhost instance in the process (via a
+// juce::SharedResourcePointer), that run the big tail stages of the convolution engines off the
+// audio thread. every job has a deadline, and the workers always take whichever queued job is
+// due soonest -- so a stage that's needed in 10ms goes ahead of one that's not needed for 100ms,
+// whichever instance they belong to.
+//
+// the audio thread side (submit and complete) never allocates, and never waits on a lock a
+// worker could be holding for long. the queue is guarded by a spin lock that's only ever held
+// for a handful of instructions, and workers with nothing to do sleep on a semaphore that
+// submit() posts to without locking anything -- and only if one of them is actually asleep.
+// the one wait there is, in complete(), is for a run a worker is already partway through.
+class ConvolutionWorkerPool
+{
+public:
+    // a job that gets run over and over. it's owned by whoever submits it, and must stay alive
+    // until it's been completed or cancelled.
+    class Task
+    {
+    public:
+        virtual ~Task() = default;
+        virtual void run() noexcept = 0;
+
+    private:
+        friend class ConvolutionWorkerPool;
+
+        enum State { idle, queued, running, finished };
+        std::atomic<int> state { idle };
+    };
+
+    ConvolutionWorkerPool();
+    ~ConvolutionWorkerPool();
+
+    // audio thread: queues the task to be done by the deadline (in ms, on the
+    // juce::Time::getMillisecondCounterHiRes clock). returns false if the queue's full, in which
+    // case the task hasn't been queued and the caller should just run it itself.
+    bool submit(Task& task, double deadline) noexcept;
+
+    // audio thread: makes sure a submitted task is done, and returns once it is. if no worker has
+    // picked it up yet we take it back and run it right here -- that's the fallback for when the
+    // workers fall behind. if a worker's already halfway through it, we wait for it to finish,
+    // since the worker owns the task's buffers until then. that wait is never for more than
+    // what's left of a single run, on a highest-priority thread that started it before we got
+    // here -- so it's never longer than running the task ourselves would have been, unless the
+    // system takes the worker's core away from it partway through.
+    void complete(Task& task) noexcept;
+
+    // pulls a task out of the queue, waiting for it if a worker's running it. call this before
+    // destroying a task that might have been submitted -- but not from the audio thread.
+    void cancel(Task& task);
+
+    int getNumWorkers() const { return workers.size(); }
+
+private:
+    class Worker;
+
+    // a counting semaphore whose post never takes a lock, so the audio thread can wake a worker.
+    // it's the platform's own where there is one, and a short poll everywhere else.
+    class Semaphore;
+
+    // takes the queued task with the earliest deadline and marks it as running, or returns
+    // nullptr if there's nothing to do.
+    Task* claimNextTask() noexcept;
+
+    struct Entry
+    {
+        double deadline;
+        Task* task;
+
+        bool operator<(const Entry& other) const noexcept { return deadline > other.deadline; }
+    };
+
+    // a binary heap with the earliest deadline at the front. it's a fixed size, so submitting
+    // never allocates. entries for tasks that got run inline stay behind until a worker pops
+    // them and sees they've already been dealt with.
+    static constexpr int queueCapacity = 1024;
+    std::array<Entry, (size_t) queueCapacity> queue;
+    int queueSize = 0;
+    juce::SpinLock queueLock;
+
+    // how many workers are asleep, or about to be. submit() only posts when it's more than zero,
+    // so a busy pool costs the audio thread nothing beyond the queue.
+    std::atomic<int> numSleeping { 0 };
+    std::unique_ptr<Semaphore> workAvailable;
+    juce::OwnedArray<Worker> workers;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ConvolutionWorkerPool)
+};
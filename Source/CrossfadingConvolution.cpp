@@ -0,0 +1,253 @@
+/*
+  ==============================================================================
+    CrossfadingConvolution.cpp
+    Created: 17 Oct 2026
+  ==============================================================================
+*/
+
+#include "CrossfadingConvolution.h"
+
+void CrossfadingConvolution::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    sampleRate = spec.sampleRate;
+    outgoingBuffer.setSize((int) spec.numChannels, (int) spec.maximumBlockSize);
+
+    // anything we were holding was built for the old spec.
+    handoff.discardPending();
+    standbyHandoff.discardPending();
+    activeEngine.reset();
+    outgoingEngine.reset();
+    standbyEngine.reset();
+    switchRequested = false;
+    standbyDiscardRequested = false;
+    crossfadeSamplesRemaining = 0;
+    collectGarbage();
+}
+
+void CrossfadingConvolution::reset()
+{
+    if (activeEngine != nullptr)
+        activeEngine->reset();
+
+    crossfadeSamplesRemaining = 0;
+    finishCrossfade();
+}
+
+std::unique_ptr<CrossfadingConvolution::Engine> CrossfadingConvolution::createEngine(const juce::AudioBuffer<float>& impulseResponse,
+                                                                                     double impulseResponseSampleRate,
+                                                                                     const juce::dsp::ProcessSpec& spec,
+                                                                                     const Engine::Scheme& scheme,
+                                                                                     const Engine::Layout& layout,
+                                                                                     const std::shared_ptr<const Engine::Spectra>& spectra)
+{
+    auto engine = std::make_unique<Engine>(scheme);
+    engine->prepare(spec);
+    engine->loadImpulseResponse(impulseResponse, impulseResponseSampleRate, true, layout, spectra);
+    return engine;
+}
+
+void CrossfadingConvolution::setEngine(std::unique_ptr<Engine> newEngine)
+{
+    handoff.discardPending();
+    activeEngine = std::move(newEngine);
+    outgoingEngine.reset();
+    crossfadeSamplesRemaining = 0;
+    handoff.collectGarbage();
+}
+
+void CrossfadingConvolution::publish(std::unique_ptr<Engine> newEngine)
+{
+    handoff.publish(std::move(newEngine));
+}
+
+void CrossfadingConvolution::publishAndLoadDeferredStages(std::unique_ptr<Engine> newEngine, const std::function<bool()>& shouldStop)
+{
+    // once it's published, the engine can be retired and deleted at any moment -- but not while
+    // it's loading, so it has to be claimed before it goes.
+    auto* engine = newEngine.get();
+    const bool claimed = engine != nullptr && engine->claimDeferredStages();
+
+    handoff.publish(std::move(newEngine));
+
+    if (claimed)
+        engine->loadDeferredStages(shouldStop);
+}
+
+void CrossfadingConvolution::publishStandby(std::unique_ptr<Engine> newEngine)
+{
+    standbyHandoff.publish(std::move(newEngine));
+
+    // the engine we switched away from gets retired through the main handoff, which only
+    // collects when something's published there.
+    handoff.collectGarbage();
+}
+
+void CrossfadingConvolution::discardStandby()
+{
+    standbyHandoff.discardPending();
+    standbyDiscardRequested.store(true, std::memory_order_release);
+}
+
+void CrossfadingConvolution::beginCrossfade() noexcept
+{
+    crossfadeSamplesRemaining = juce::roundToInt(crossfadeLengthSeconds.load() * sampleRate);
+
+    if (outgoingEngine == nullptr || crossfadeSamplesRemaining <= 0)
+    {
+        crossfadeSamplesRemaining = 0;
+        finishCrossfade();
+        return;
+    }
+
+    // the gains trace out a quarter circle, so cos^2 + sin^2 stays at 1 the whole way and the
+    // level holds steady even though the two tails are uncorrelated.
+    const auto step = juce::MathConstants<double>::halfPi / (double) crossfadeSamplesRemaining;
+    fadeCos = 1.0;
+    fadeSin = 0.0;
+    stepCos = std::cos(step);
+    stepSin = std::sin(step);
+}
+
+void CrossfadingConvolution::finishCrossfade() noexcept
+{
+    // the outgoing engine gets deleted on a background thread. on the off chance the handoff has
+    // no room for it, we hold on to it (silently) and try again next block.
+    if (outgoingEngine != nullptr && handoff.retire(outgoingEngine.get()))
+        outgoingEngine.release();
+}
+
+void CrossfadingConvolution::takeHandoffs(bool fade) noexcept
+{
+    // the standby engine doesn't run, so it can be swapped or dropped at any time.
+    if (standbyDiscardRequested.load(std::memory_order_acquire) && standbyHandoff.retire(standbyEngine.get()))
+    {
+        standbyEngine.release();
+        standbyDiscardRequested.store(false, std::memory_order_relaxed);
+        switchRequested.store(false, std::memory_order_relaxed);
+    }
+
+    standbyHandoff.acquire(standbyEngine);
+
+    // only take a new engine when we're not already mid-fade -- that way there are never more
+    // than two engines running. anything published goes in before a switch to the standby
+    // engine, as the standby was built to stand in for it.
+    if (outgoingEngine == nullptr)
+    {
+        std::unique_ptr<Engine> incoming;
+        if (handoff.acquire(incoming))
+        {
+            outgoingEngine = std::move(activeEngine);
+            activeEngine = std::move(incoming);
+        }
+        else if (standbyEngine != nullptr && switchRequested.exchange(false, std::memory_order_acq_rel))
+        {
+            outgoingEngine = std::move(activeEngine);
+            activeEngine = std::move(standbyEngine);
+        }
+        else
+        {
+            return;
+        }
+
+        if (fade)
+        {
+            beginCrossfade();
+        }
+        else
+        {
+            crossfadeSamplesRemaining = 0;
+            finishCrossfade();
+        }
+    }
+}
+
+void CrossfadingConvolution::processSilence() noexcept
+{
+    // with nothing coming out, there's nothing to fade: a fade that was underway is over, and
+    // anything new goes straight in.
+    crossfadeSamplesRemaining = 0;
+    finishCrossfade();
+    takeHandoffs(false);
+
+    numPartitions.store(activeEngine != nullptr ? activeEngine->getNumPartitions() : 0, std::memory_order_relaxed);
+    numActivePartitions.store(0, std::memory_order_relaxed);
+}
+
+void CrossfadingConvolution::process(const juce::dsp::ProcessContextReplacing<float>& context) noexcept
+{
+    auto& block = context.getOutputBlock();
+
+    if (outgoingEngine != nullptr && crossfadeSamplesRemaining == 0)
+        finishCrossfade();
+
+    takeHandoffs(true);
+
+    if (activeEngine == nullptr)
+    {
+        numPartitions.store(0, std::memory_order_relaxed);
+        numActivePartitions.store(0, std::memory_order_relaxed);
+        block.clear();
+        return;
+    }
+
+    const auto numChannels = juce::jmin(block.getNumChannels(), (size_t) outgoingBuffer.getNumChannels());
+    const auto numSamples = block.getNumSamples();
+    const bool fading = outgoingEngine != nullptr && crossfadeSamplesRemaining > 0;
+
+    const auto currentDecayTime = decayTime.load(std::memory_order_relaxed);
+    const auto currentEarlyGain = earlyGain.load(std::memory_order_relaxed);
+    const auto currentLateGain = lateGain.load(std::memory_order_relaxed);
+    activeEngine->setDecayTime(currentDecayTime);
+    activeEngine->setEarlyLateGains(currentEarlyGain, currentLateGain);
+
+    juce::dsp::AudioBlock<float> outgoingBlock;
+    if (fading)
+    {
+        jassert(numSamples <= (size_t) outgoingBuffer.getNumSamples());
+
+        outgoingBlock = juce::dsp::AudioBlock<float>(outgoingBuffer)
+            .getSubsetChannelBlock(0, numChannels)
+            .getSubBlock(0, numSamples);
+
+        outgoingBlock.copyFrom(block);
+        outgoingEngine->setDecayTime(currentDecayTime);
+        outgoingEngine->setEarlyLateGains(currentEarlyGain, currentLateGain);
+        outgoingEngine->process(juce::dsp::ProcessContextReplacing<float>(outgoingBlock));
+    }
+
+    activeEngine->process(context);
+
+    // counted after the engines have run, so any decay change this block is already in them.
+    numPartitions.store(activeEngine->getNumPartitions() + (fading ? outgoingEngine->getNumPartitions() : 0),
+                        std::memory_order_relaxed);
+    numActivePartitions.store(activeEngine->getNumActivePartitions() + (fading ? outgoingEngine->getNumActivePartitions() : 0),
+                              std::memory_order_relaxed);
+
+    if (! fading)
+        return;
+
+    // blend the two over whatever's left of the fade. anything in this block past the end of
+    // the fade is already just the new engine.
+    const auto fadeSamples = (size_t) juce::jmin((int) numSamples, crossfadeSamplesRemaining);
+
+    for (size_t i = 0; i < fadeSamples; ++i)
+    {
+        const auto outgoingGain = (float) fadeCos;
+        const auto incomingGain = (float) fadeSin;
+
+        for (size_t c = 0; c < numChannels; ++c)
+        {
+            auto* out = block.getChannelPointer(c);
+            out[i] = out[i] * incomingGain + outgoingBlock.getChannelPointer(c)[i] * outgoingGain;
+        }
+
+        const auto nextCos = fadeCos * stepCos - fadeSin * stepSin;
+        fadeSin = fadeSin * stepCos + fadeCos * stepSin;
+        fadeCos = nextCos;
+    }
+
+    crossfadeSamplesRemaining -= (int) fadeSamples;
+
+    if (crossfadeSamplesRemaining == 0)
+        finishCrossfade();
+}
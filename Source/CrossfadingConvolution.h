@@ -0,0 +1,157 @@
+/*
+  ==============================================================================
+    CrossfadingConvolution.h
+    Created: 17 Oct 2026
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "RealtimeHandoff.h"
+#include "PartitionedConvolver.h"
+
+// a convolution stage that can swap its IR without clicks. loading a new IR into a single
+// engine throws away the input history it was holding, which is what made automating the decay
+// time zip and drop out. instead, every IR gets its own fully built engine, and when a new one
+// arrives the outgoing engine keeps running alongside it for a short crossfade window, blended
+// with an equal-power curve. once the fade is done, the outgoing engine is retired -- so outside
+// of a transition we're only ever paying for one engine.
+//
+// engines are built up front on a background thread (createEngine) and handed over through a
+// RealtimeHandoff, so nothing on the audio thread locks, allocates or frees.
+//
+// there can also be a standby engine: one that's built and resident, but not running, so that
+// switching to it is just a crossfade with nothing to build first. the processor uses it to keep
+// the other orientation of the IR ready for the Reverse button.
+class CrossfadingConvolution
+{
+public:
+    using Engine = PartitionedConvolver;
+
+    static constexpr double defaultCrossfadeLengthSeconds = 0.1;
+
+    CrossfadingConvolution() = default;
+
+    // allocates the scratch space for the outgoing engine and drops everything we were holding.
+    // call this before processing, never at the same time as process().
+    void prepare(const juce::dsp::ProcessSpec& spec);
+
+    // clears the state of the running engine and cuts any crossfade short.
+    void reset();
+
+    // builds an engine for this IR that's ready to process straight away. this does all of the
+    // heavy lifting (resampling, normalising and the partition FFTs), so call it off the audio
+    // thread. the layout is passed on to the engine -- see PartitionedConvolver::Layout -- and so
+    // are the spectra of an earlier engine built the same way, if there are any, which saves the
+    // FFTs.
+    static std::unique_ptr<Engine> createEngine(const juce::AudioBuffer<float>& impulseResponse, double impulseResponseSampleRate,
+                                                const juce::dsp::ProcessSpec& spec, const Engine::Scheme& scheme = {},
+                                                const Engine::Layout& layout = {},
+                                                const std::shared_ptr<const Engine::Spectra>& spectra = nullptr);
+
+    // swaps an engine in immediately, without a fade. same rules as prepare().
+    void setEngine(std::unique_ptr<Engine> newEngine);
+
+    // queues an engine to be faded in on the next block. safe from any thread except the audio
+    // thread. if a fade is already underway, the new engine waits for it to finish, and only the
+    // newest engine published in the meantime is kept.
+    void publish(std::unique_ptr<Engine> newEngine);
+
+    // publishes an engine that was built with a deferred start, and then stays to load the rest
+    // of its stages (see PartitionedConvolver::loadDeferredStages) while it plays. returns once
+    // they're all in, shouldStop fires, or the engine's been thrown away.
+    void publishAndLoadDeferredStages(std::unique_ptr<Engine> newEngine, const std::function<bool()>& shouldStop);
+
+    // hands over an engine to keep on standby, replacing the one we had. same rules as publish().
+    void publishStandby(std::unique_ptr<Engine> newEngine);
+
+    // lets go of the standby engine (and anything published for it) on the next block.
+    void discardStandby();
+
+    // asks the audio thread to crossfade over to the standby engine, as soon as it has one and
+    // isn't already mid-fade. the engine it was running is retired, and it's on the caller to
+    // publish another standby if it wants one. safe from any thread.
+    void switchToStandby() noexcept { switchRequested.store(true, std::memory_order_release); }
+    void cancelSwitch() noexcept { switchRequested.store(false, std::memory_order_release); }
+    bool isSwitchPending() const noexcept { return switchRequested.load(std::memory_order_acquire); }
+
+    // deletes engines the audio thread has finished with. publish() does this as well.
+    void collectGarbage()
+    {
+        handoff.collectGarbage();
+        standbyHandoff.collectGarbage();
+    }
+
+    // the decay time and early/late balance for engines whose layout has them. they're handed to
+    // whichever engines are running at the start of every block, so one that's just been swapped
+    // in picks them up too.
+    void setDecayTime(float seconds) noexcept { decayTime.store(seconds, std::memory_order_relaxed); }
+
+    void setEarlyLateGains(float early, float late) noexcept
+    {
+        earlyGain.store(early, std::memory_order_relaxed);
+        lateGain.store(late, std::memory_order_relaxed);
+    }
+
+    void setCrossfadeLength(double seconds) { crossfadeLengthSeconds = juce::jmax(0.0, seconds); }
+    double getCrossfadeLength() const { return crossfadeLengthSeconds.load(); }
+
+    void process(const juce::dsp::ProcessContextReplacing<float>& context) noexcept;
+
+    // for a block the caller isn't running us for, because it knows the output would be silent.
+    // nothing gets processed, but whatever's been handed over is still taken -- with no fade, as
+    // there's nothing to hear -- so a switch or a new engine never waits on the input coming
+    // back. counts as no partitions running.
+    void processSilence() noexcept;
+
+    // the latency of the engine that's running now. engines built with a different scheme can
+    // have a different latency, so this can change when a new one's swapped in.
+    int getLatency() const { return activeEngine != nullptr ? activeEngine->getLatency() : 0; }
+    bool isCrossfading() const noexcept { return outgoingEngine != nullptr; }
+
+    // how many partitions the running engines hold between them, and how many of those they're
+    // actually running (see PartitionedConvolver::getNumActivePartitions) -- both engines' while
+    // a fade is underway. updated every block, and safe to read from any thread.
+    int getNumPartitions() const noexcept { return numPartitions.load(std::memory_order_relaxed); }
+    int getNumActivePartitions() const noexcept { return numActivePartitions.load(std::memory_order_relaxed); }
+
+private:
+    // takes whatever's been handed over since the last block: a standby to drop or pick up, and
+    // a new engine (or a switch to the standby) that either gets faded over to, or goes straight
+    // in with the old one retired.
+    void takeHandoffs(bool fade) noexcept;
+
+    void beginCrossfade() noexcept;
+    void finishCrossfade() noexcept;
+
+    RealtimeHandoff<Engine> handoff;
+    RealtimeHandoff<Engine> standbyHandoff;
+
+    // the engines each grab the shared worker pool, but holding on to it here as well keeps its
+    // threads alive while one engine is being swapped for the next.
+    juce::SharedResourcePointer<ConvolutionWorkerPool> workerPool;
+
+    std::unique_ptr<Engine> activeEngine;
+    std::unique_ptr<Engine> outgoingEngine;
+    std::unique_ptr<Engine> standbyEngine;
+    std::atomic<bool> switchRequested { false };
+    std::atomic<bool> standbyDiscardRequested { false };
+
+    // a copy of the input for the outgoing engine while we're fading.
+    juce::AudioBuffer<float> outgoingBuffer;
+
+    double sampleRate = 44100.0;
+    std::atomic<double> crossfadeLengthSeconds { defaultCrossfadeLengthSeconds };
+    std::atomic<float> decayTime { 0.0f };
+    std::atomic<float> earlyGain { 1.0f }, lateGain { 1.0f };
+    std::atomic<int> numPartitions { 0 }, numActivePartitions { 0 };
+
+    // the fade position as a rotating (cos, sin) pair -- stepping it along is just a complex
+    // multiply per sample, rather than a pair of trig calls.
+    int crossfadeSamplesRemaining = 0;
+    double fadeCos = 1.0, fadeSin = 0.0;
+    double stepCos = 1.0, stepSin = 0.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CrossfadingConvolution)
+};
@@ -0,0 +1,295 @@
+/*
+  ==============================================================================
+    FeedbackDelayNetwork.cpp
+    Created: 17 Oct 2026
+  ==============================================================================
+*/
+
+#include "FeedbackDelayNetwork.h"
+
+namespace
+{
+    // the line lengths, spread unevenly over a factor of three or so. every output's network
+    // stretches them by a little more, so the outputs don't ring at the same frequencies.
+    constexpr std::array<double, FeedbackDelayNetwork::numLines> lineMilliseconds {
+        23.1, 26.3, 29.9, 33.7, 37.3, 40.9, 44.1, 47.9,
+        51.1, 54.7, 58.3, 61.9, 65.3, 69.1, 72.7, 77.3
+    };
+
+    constexpr double outputStretch = 0.053;
+
+    // the unnormalised transform gains 16 in energy, so a quarter in amplitude puts it back.
+    constexpr float hadamardScale = 0.25f;
+
+    bool isPrime(int n)
+    {
+        if (n < 2)
+            return false;
+
+        for (int d = 2; d * d <= n; ++d)
+            if (n % d == 0)
+                return false;
+
+        return true;
+    }
+
+    int nextPrime(int n)
+    {
+        while (! isPrime(n))
+            ++n;
+
+        return n;
+    }
+
+    // in place, across numRows rows of numSamples each. a butterfly at a time, so each one is a
+    // straight pass along two rows.
+    void walshHadamard(float* const* rows, int numRows, int numSamples) noexcept
+    {
+        for (int h = 1; h < numRows; h *= 2)
+            for (int i = 0; i < numRows; i += 2 * h)
+                for (int j = i; j < i + h; ++j)
+                {
+                    auto* a = rows[j];
+                    auto* b = rows[j + h];
+
+                    for (int k = 0; k < numSamples; ++k)
+                    {
+                        const auto x = a[k];
+                        const auto y = b[k];
+                        a[k] = x + y;
+                        b[k] = x - y;
+                    }
+                }
+    }
+}
+
+void FeedbackDelayNetwork::prepare(double newSampleRate, int newNumInputs, int numOutputs)
+{
+    jassert(newNumInputs <= numLines);
+
+    sampleRate = newSampleRate;
+    numInputs = newNumInputs;
+    networks.resize((size_t) numOutputs);
+
+    int longestLine = 0;
+    shortestLine = std::numeric_limits<int>::max();
+
+    for (int o = 0; o < numOutputs; ++o)
+    {
+        auto& network = networks[(size_t) o];
+
+        // a fixed seed, so the same settings always give the same sound.
+        juce::Random random(0x46444e + o);
+
+        for (int i = 0; i < numLines; ++i)
+        {
+            const auto stretch = 1.0 + outputStretch * o;
+            network.lengths[(size_t) i] = nextPrime(juce::roundToInt(lineMilliseconds[(size_t) i] * stretch * sampleRate / 1000.0));
+            network.outputSigns[(size_t) i] = random.nextBool() ? 1.0f : -1.0f;
+
+            longestLine = juce::jmax(longestLine, network.lengths[(size_t) i]);
+            shortestLine = juce::jmin(shortestLine, network.lengths[(size_t) i]);
+        }
+
+        // each input's signs are a different row of a Hadamard matrix, with the same random signs
+        // on top -- orthogonal, so two inputs into the same network come out uncorrelated, as two
+        // paths of an IR would be.
+        std::array<float, numLines> scramble {};
+        for (auto& sign : scramble)
+            sign = random.nextBool() ? 1.0f : -1.0f;
+
+        network.inputSigns.resize((size_t) numInputs);
+        for (int in = 0; in < numInputs; ++in)
+            for (int i = 0; i < numLines; ++i)
+                network.inputSigns[(size_t) in][(size_t) i] = (juce::countNumberOfBits((juce::uint32) (in & i)) & 1) != 0 ? -scramble[(size_t) i]
+                                                                                                               : scramble[(size_t) i];
+
+        network.inputGains.assign((size_t) numInputs, 0.0f);
+    }
+
+    // a step never runs longer than the shortest line, so the oldest sample it reads is the
+    // longest line back from its start.
+    const int ringSize = juce::nextPowerOfTwo(longestLine + shortestLine);
+    lineMask = ringSize - 1;
+
+    for (auto& network : networks)
+        network.lines.setSize(numLines, ringSize);
+
+    rows.setSize(numLines, shortestLine);
+
+    setDecayRate(decayRate);
+    reset();
+}
+
+void FeedbackDelayNetwork::reset()
+{
+    for (auto& network : networks)
+    {
+        network.lines.clear();
+        network.toneState = 0.0f;
+    }
+
+    samplesProcessed = 0;
+}
+
+void FeedbackDelayNetwork::setInputGain(int input, int output, float gain)
+{
+    networks[(size_t) output].inputGains[(size_t) input] = gain;
+}
+
+void FeedbackDelayNetwork::setToneCoefficient(float coefficient)
+{
+    toneCoefficient = coefficient;
+}
+
+void FeedbackDelayNetwork::setDecayRate(double rate) noexcept
+{
+    decayRate = rate;
+
+    for (auto& network : networks)
+        for (int i = 0; i < numLines; ++i)
+            network.feedbackGains[(size_t) i] = (float) std::exp(-decayRate * network.lengths[(size_t) i]);
+}
+
+double FeedbackDelayNetwork::getImpulseResponsePower(int input, int output) const
+{
+    // once the lines are all full the power holds steady, so a second or so after that is plenty.
+    const auto& network = networks[(size_t) output];
+    const int settle = 2 * *std::max_element(network.lengths.begin(), network.lengths.end());
+    const int length = juce::roundToInt(sampleRate);
+    const auto response = render(network, input, 1.0f, settle + length);
+
+    double sum = 0.0;
+    for (int t = settle; t < settle + length; ++t)
+        sum += (double) response[(size_t) t] * response[(size_t) t];
+
+    return sum / length;
+}
+
+std::vector<float> FeedbackDelayNetwork::renderImpulseResponse(int input, int output, int numSamples) const
+{
+    const auto& network = networks[(size_t) output];
+    return render(network, input, network.inputGains[(size_t) input], numSamples);
+}
+
+std::vector<float> FeedbackDelayNetwork::render(const Network& network, int input, float gain, int numSamples) const
+{
+    // the same steps as processNetwork(), a sample at a time and with nothing lost.
+    const auto size = lineMask + 1;
+
+    std::vector<std::vector<float>> lines((size_t) numLines, std::vector<float>((size_t) size, 0.0f));
+    std::array<float, numLines> values {};
+    std::array<float*, numLines> valuePointers {};
+    for (int i = 0; i < numLines; ++i)
+        valuePointers[(size_t) i] = &values[(size_t) i];
+
+    std::vector<float> result((size_t) numSamples, 0.0f);
+    float toneState = 0.0f;
+
+    for (int t = 0; t < numSamples; ++t)
+    {
+        float sum = 0.0f;
+        for (int i = 0; i < numLines; ++i)
+        {
+            values[(size_t) i] = lines[(size_t) i][(size_t) ((t - network.lengths[(size_t) i]) & lineMask)];
+            sum += values[(size_t) i] * network.outputSigns[(size_t) i];
+        }
+
+        toneState = (1.0f - toneCoefficient) * sum + toneCoefficient * toneState;
+        result[(size_t) t] = toneState;
+
+        walshHadamard(valuePointers.data(), numLines, 1);
+
+        const auto in = t == 0 ? gain : 0.0f;
+        for (int i = 0; i < numLines; ++i)
+            lines[(size_t) i][(size_t) (t & lineMask)] = values[(size_t) i] * hadamardScale
+                                                         + in * network.inputSigns[(size_t) input][(size_t) i];
+    }
+
+    return result;
+}
+
+void FeedbackDelayNetwork::process(const float* const* input, float* const* output, int numSamples, float inputGain) noexcept
+{
+    // a step at a time, none of them longer than the shortest line, so nothing a step writes is
+    // read back in it.
+    for (int done = 0; done < numSamples;)
+    {
+        const int stepSize = juce::jmin(numSamples - done, shortestLine);
+
+        for (size_t o = 0; o < networks.size(); ++o)
+            processNetwork(networks[o], input, done, output[o] + done, stepSize, inputGain);
+
+        samplesProcessed += stepSize;
+        done += stepSize;
+    }
+}
+
+void FeedbackDelayNetwork::processNetwork(Network& network, const float* const* input, int inputOffset, float* output, int numSamples, float inputGain) noexcept
+{
+    const auto size = network.lines.getNumSamples();
+    auto* const* rowPointers = rows.getArrayOfWritePointers();
+
+    // each line's output for the step, taken down by its decay on the way out.
+    for (int i = 0; i < numLines; ++i)
+    {
+        const auto* ring = network.lines.getReadPointer(i);
+        const auto start = (int) ((samplesProcessed - network.lengths[(size_t) i]) & lineMask);
+        const int firstRun = juce::jmin(numSamples, size - start);
+        const auto gain = network.feedbackGains[(size_t) i];
+
+        juce::FloatVectorOperations::copyWithMultiply(rowPointers[i], ring + start, gain, firstRun);
+        juce::FloatVectorOperations::copyWithMultiply(rowPointers[i] + firstRun, ring, gain, numSamples - firstRun);
+    }
+
+    juce::FloatVectorOperations::clear(output, numSamples);
+    for (int i = 0; i < numLines; ++i)
+        juce::FloatVectorOperations::addWithMultiply(output, rowPointers[i], network.outputSigns[(size_t) i], numSamples);
+
+    if (toneCoefficient > 0.0f)
+    {
+        const auto a = toneCoefficient;
+        auto state = network.toneState;
+
+        for (int k = 0; k < numSamples; ++k)
+            output[k] = state = (1.0f - a) * output[k] + a * state;
+
+        network.toneState = state;
+    }
+
+    walshHadamard(rowPointers, numLines, numSamples);
+
+    // back into the lines, with the input on top.
+    const auto start = (int) (samplesProcessed & lineMask);
+    const int firstRun = juce::jmin(numSamples, size - start);
+
+    for (int i = 0; i < numLines; ++i)
+    {
+        auto* row = rowPointers[i];
+        juce::FloatVectorOperations::multiply(row, hadamardScale, numSamples);
+
+        for (int in = 0; in < numInputs; ++in)
+        {
+            const auto gain = network.inputGains[(size_t) in];
+            if (gain == 0.0f)
+                continue;
+
+            juce::FloatVectorOperations::addWithMultiply(row, input[in] + inputOffset,
+                                                         inputGain * gain * network.inputSigns[(size_t) in][(size_t) i], numSamples);
+        }
+
+        auto* ring = network.lines.getWritePointer(i);
+        juce::FloatVectorOperations::copy(ring + start, row, firstRun);
+        juce::FloatVectorOperations::copy(ring, row + firstRun, numSamples - firstRun);
+    }
+}
+
+size_t FeedbackDelayNetwork::getMemorySize() const
+{
+    size_t bytes = (size_t) rows.getNumChannels() * (size_t) rows.getNumSamples() * sizeof(float);
+
+    for (const auto& network : networks)
+        bytes += (size_t) network.lines.getNumChannels() * (size_t) network.lines.getNumSamples() * sizeof(float);
+
+    return bytes;
+}
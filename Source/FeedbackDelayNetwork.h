@@ -0,0 +1,96 @@
+/*
+  ==============================================================================
+    FeedbackDelayNetwork.h
+    Created: 17 Oct 2026
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// a feedback delay network, for the far end of a long tail. past the first few hundred ms the
+// IR is just decaying noise, and convolving with it costs more the longer the decay -- a network
+// of recirculating delay lines makes the same kind of noise for a fixed cost, however long it
+// rings on for.
+//
+// each output gets a network of its own: numLines delay lines, mixed back into each other through
+// a Hadamard matrix (orthogonal, so it neither gains nor loses energy), with every line's length
+// a prime number of samples so the echoes never line up. the matrix runs as a fast Walsh-Hadamard
+// transform -- 64 adds and subtracts for 16 lines, rather than 256 multiply-adds. every input
+// feeds every line, with a sign per line and a gain per input, and the output is the lines'
+// outputs summed with a sign each, then through a one-pole lowpass for its spectral tilt.
+//
+// the shortest line is longer than a block, so nothing written in a block is read back in the
+// same one. that means the whole network can run a block at a time, each step of it one
+// vectorised pass across the block.
+//
+// every line is taken down by the same amount per sample, so the impulse response is the lossless
+// network's times a plain exponential decay -- which is what lets it take over from an IR whose
+// decay is put on the same way.
+class FeedbackDelayNetwork
+{
+public:
+    static constexpr int numLines = 16;
+
+    FeedbackDelayNetwork() = default;
+
+    // sets the lines up at this rate. allocates, so not for the audio thread.
+    void prepare(double sampleRate, int numInputs, int numOutputs);
+    void reset();
+
+    // how much of each input goes into each output's network -- zero for none at all.
+    void setInputGain(int input, int output, float gain);
+
+    // the coefficient of the output lowpass: zero for none, up towards one for darker.
+    void setToneCoefficient(float coefficient);
+
+    // the decay, as the fraction of a neper lost per sample. zero leaves it lossless.
+    void setDecayRate(double rate) noexcept;
+
+    // the average power per sample of the lossless network's impulse response, on one path with
+    // an input gain of one -- what a path's gain has to level to the IR it takes over from.
+    // measured rather than worked out, since how the lines add up depends on the path's signs.
+    double getImpulseResponsePower(int input, int output) const;
+
+    // the lossless network's impulse response from one input to one output, input gain included.
+    std::vector<float> renderImpulseResponse(int input, int output, int numSamples) const;
+
+    // runs numSamples of every input through, with inputGain on all of them, and writes every
+    // output.
+    void process(const float* const* input, float* const* output, int numSamples, float inputGain) noexcept;
+
+    size_t getMemorySize() const;
+
+private:
+    struct Network
+    {
+        std::array<int, numLines> lengths {};
+        std::array<float, numLines> outputSigns {};
+        std::array<float, numLines> feedbackGains {};
+        std::vector<std::array<float, numLines>> inputSigns;
+        std::vector<float> inputGains;
+        juce::AudioBuffer<float> lines;
+        float toneState = 0.0f;
+    };
+
+    std::vector<float> render(const Network& network, int input, float gain, int numSamples) const;
+    void processNetwork(Network& network, const float* const* input, int inputOffset, float* output, int numSamples, float inputGain) noexcept;
+
+    double sampleRate = 44100.0;
+    int numInputs = 0;
+    std::vector<Network> networks;
+
+    // every line's ring is the same size, indexed by absolute sample time.
+    juce::int64 lineMask = 0;
+    juce::int64 samplesProcessed = 0;
+    int shortestLine = 0;
+
+    float toneCoefficient = 0.0f;
+    double decayRate = 0.0;
+
+    // one row per line, for the block being worked on.
+    juce::AudioBuffer<float> rows;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FeedbackDelayNetwork)
+};
@@ -0,0 +1,191 @@
+/*
+  ==============================================================================
+    ImpulseResponseCache.cpp
+    Created: 17 Oct 2026
+  ==============================================================================
+*/
+
+#include "ImpulseResponseCache.h"
+
+ImpulseResponseCache::Key::Key(float decayTime, bool reverseReverb, double sampleRate, int quality, juce::uint32 noiseSeed,
+                               bool isTrueStereo, float noiseFloor)
+    : decayTimeMs(juce::roundToInt(decayTime * 1000.0f)),
+      reverse(reverseReverb),
+      sampleRateHz(juce::roundToInt(sampleRate)),
+      qualityMode(quality),
+      seed(noiseSeed),
+      trueStereo(isTrueStereo),
+      noiseFloorDecibels(juce::roundToInt(noiseFloor))
+{
+}
+
+bool ImpulseResponseCache::Key::operator<(const Key& other) const
+{
+    return std::tie(decayTimeMs, reverse, sampleRateHz, qualityMode, seed, trueStereo, noiseFloorDecibels)
+         < std::tie(other.decayTimeMs, other.reverse, other.sampleRateHz, other.qualityMode, other.seed, other.trueStereo,
+                    other.noiseFloorDecibels);
+}
+
+bool ImpulseResponseCache::Key::operator==(const Key& other) const
+{
+    return ! (*this < other) && ! (other < *this);
+}
+
+ImpulseResponseCache::SpectraKey::SpectraKey(float decayTime, bool reverseReverb, double sampleRate, juce::uint32 noiseSeed,
+                                             bool isTrueStereo, int decimationFactor, bool isZeroLatency, bool hasSplitBands,
+                                             bool hasFeedbackTail, float noiseFloor)
+    : decayTimeMs(juce::roundToInt(decayTime * 1000.0f)),
+      reverse(reverseReverb),
+      sampleRateHz(juce::roundToInt(sampleRate)),
+      seed(noiseSeed),
+      trueStereo(isTrueStereo),
+      decimation(decimationFactor),
+      zeroLatency(isZeroLatency),
+      splitBands(hasSplitBands),
+      feedbackTail(hasFeedbackTail),
+      noiseFloorDecibels(juce::roundToInt(noiseFloor))
+{
+}
+
+bool ImpulseResponseCache::SpectraKey::operator<(const SpectraKey& other) const
+{
+    return std::tie(decayTimeMs, reverse, sampleRateHz, seed, trueStereo, decimation, zeroLatency, splitBands, feedbackTail,
+                    noiseFloorDecibels)
+         < std::tie(other.decayTimeMs, other.reverse, other.sampleRateHz, other.seed, other.trueStereo, other.decimation,
+                    other.zeroLatency, other.splitBands, other.feedbackTail, other.noiseFloorDecibels);
+}
+
+ImpulseResponseCache::ImpulseResponseCache(size_t maximumSizeInBytes)
+    : maximumSize(maximumSizeInBytes)
+{
+}
+
+std::shared_ptr<const PreparedImpulseResponse> ImpulseResponseCache::get(const Key& key)
+{
+    const juce::ScopedLock sl(lock);
+
+    auto found = index.find(key);
+    if (found == index.end())
+        return nullptr;
+
+    // bump it to the front -- splice just relinks the node, so the iterator stays valid.
+    entries.splice(entries.begin(), entries, found->second);
+    return found->second->impulseResponse;
+}
+
+void ImpulseResponseCache::insert(const Key& key, std::shared_ptr<const PreparedImpulseResponse> impulseResponse)
+{
+    if (impulseResponse == nullptr)
+        return;
+
+    Entry entry;
+    entry.key = key;
+    entry.sizeInBytes = impulseResponse->getSizeInBytes();
+    entry.impulseResponse = std::move(impulseResponse);
+
+    const juce::ScopedLock sl(lock);
+
+    auto found = index.find(key);
+    if (found != index.end())
+        erase(found->second);
+
+    add(std::move(entry));
+}
+
+std::shared_ptr<const PartitionedConvolver::Spectra> ImpulseResponseCache::getSpectra(const SpectraKey& key)
+{
+    const juce::ScopedLock sl(lock);
+
+    auto found = spectraIndex.find(key);
+    if (found == spectraIndex.end())
+        return nullptr;
+
+    entries.splice(entries.begin(), entries, found->second);
+    return found->second->spectra;
+}
+
+void ImpulseResponseCache::insertSpectra(const SpectraKey& key, std::shared_ptr<const PartitionedConvolver::Spectra> spectra)
+{
+    if (spectra == nullptr)
+        return;
+
+    jassert(spectra->isComplete());
+
+    Entry entry;
+    entry.spectraKey = key;
+    entry.sizeInBytes = spectra->getSizeInBytes();
+    entry.spectra = std::move(spectra);
+
+    const juce::ScopedLock sl(lock);
+
+    auto found = spectraIndex.find(key);
+    if (found != spectraIndex.end())
+        erase(found->second);
+
+    add(std::move(entry));
+}
+
+void ImpulseResponseCache::setMaximumSize(size_t newMaximumSizeInBytes)
+{
+    const juce::ScopedLock sl(lock);
+    maximumSize = newMaximumSizeInBytes;
+    evictUntilWithinBudget();
+}
+
+size_t ImpulseResponseCache::getMaximumSize() const
+{
+    const juce::ScopedLock sl(lock);
+    return maximumSize;
+}
+
+size_t ImpulseResponseCache::getCurrentSize() const
+{
+    const juce::ScopedLock sl(lock);
+    return currentSize;
+}
+
+void ImpulseResponseCache::clear()
+{
+    const juce::ScopedLock sl(lock);
+    entries.clear();
+    index.clear();
+    spectraIndex.clear();
+    currentSize = 0;
+}
+
+void ImpulseResponseCache::erase(std::list<Entry>::iterator entry)
+{
+    currentSize -= entry->sizeInBytes;
+
+    if (entry->spectra != nullptr)
+        spectraIndex.erase(entry->spectraKey);
+    else
+        index.erase(entry->key);
+
+    entries.erase(entry);
+}
+
+void ImpulseResponseCache::add(Entry entry)
+{
+    if (entry.sizeInBytes > maximumSize)
+        return;
+
+    currentSize += entry.sizeInBytes;
+    entries.push_front(std::move(entry));
+
+    auto& front = entries.front();
+    if (front.spectra != nullptr)
+        spectraIndex[front.spectraKey] = entries.begin();
+    else
+        index[front.key] = entries.begin();
+
+    evictUntilWithinBudget();
+}
+
+void ImpulseResponseCache::evictUntilWithinBudget()
+{
+    // evicting only drops our reference -- if the audio side is still holding on to an
+    // entry, it stays alive until that's let go as well.
+    while (currentSize > maximumSize && ! entries.empty())
+        erase(std::prev(entries.end()));
+}
@@ -0,0 +1,135 @@
+/*
+  ==============================================================================
+    ImpulseResponseCache.h
+    Created: 17 Oct 2026
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PartitionedConvolver.h"
+
+// an IR that's been through every step we can do ahead of time, so it can go straight into the
+// convolution engine without any more work.
+struct PreparedImpulseResponse
+{
+    juce::AudioBuffer<float> buffer;
+
+    // the rate the buffer should be loaded at. the lower quality modes build their IRs at a
+    // fraction of the host rate, so this isn't always the same as the session rate.
+    double sampleRate = 0.0;
+
+    // set when the buffer refers straight into a file from the disk cache, to keep the mapping
+    // alive for as long as we're around.
+    std::shared_ptr<juce::MemoryMappedFile> mappedFile;
+
+    size_t getSizeInBytes() const
+    {
+        return (size_t) buffer.getNumChannels() * (size_t) buffer.getNumSamples() * sizeof(float);
+    }
+};
+
+// a bounded, least-recently-used cache of prepared IRs. entries are addressed by the settings
+// that produced them, so flipping back and forth between two presets (or A/B-ing a knob) only
+// pays for synthesis the first time round. once the total size goes over the byte budget, the
+// entries that haven't been used for the longest get thrown out.
+//
+// it keeps the partition spectra engines were built with, too -- they're most of the work of
+// building one, and several times the size of the IR, so they share the same budget.
+//
+// everything here is guarded by a lock, so it's fine to use from any of our background threads
+// -- just not from the audio thread.
+class ImpulseResponseCache
+{
+public:
+    // everything an IR depends on. the float parameters are quantised to well below their
+    // slider step sizes, so two requests for "the same" setting always land on the same entry.
+    // the noise floor (where the IR gets cut off) goes to the nearest decibel.
+    struct Key
+    {
+        Key() = default;
+        Key(float decayTime, bool reverse, double sampleRate, int qualityMode, juce::uint32 seed,
+            bool trueStereo = false, float noiseFloorDecibels = -96.0f);
+
+        bool operator<(const Key& other) const;
+        bool operator==(const Key& other) const;
+
+        int decayTimeMs = 0;
+        bool reverse = false;
+        int sampleRateHz = 0;
+        int qualityMode = 0;
+        juce::uint32 seed = 0;
+        bool trueStereo = false;
+        int noiseFloorDecibels = -96;
+    };
+
+    // everything an engine's spectra depend on: the IR it was built from (which these settings
+    // decide), the rate it runs at, and the parts of the scheme and layout that change how the
+    // IR gets cut up. the decay time is always in here, as it moves the end of the IR even when
+    // the IR itself is shared.
+    struct SpectraKey
+    {
+        SpectraKey() = default;
+        SpectraKey(float decayTime, bool reverse, double sampleRate, juce::uint32 seed, bool trueStereo,
+                   int decimation, bool zeroLatency, bool splitBands, bool feedbackTail, float noiseFloorDecibels);
+
+        bool operator<(const SpectraKey& other) const;
+
+        int decayTimeMs = 0;
+        bool reverse = false;
+        int sampleRateHz = 0;
+        juce::uint32 seed = 0;
+        bool trueStereo = false;
+        int decimation = 1;
+        bool zeroLatency = false;
+        bool splitBands = false;
+        bool feedbackTail = false;
+        int noiseFloorDecibels = -96;
+    };
+
+    explicit ImpulseResponseCache(size_t maximumSizeInBytes);
+
+    // returns the entry for this key (marking it as the most recently used), or nullptr.
+    std::shared_ptr<const PreparedImpulseResponse> get(const Key& key);
+
+    // adds or replaces an entry, then evicts old ones until we're back under budget. an entry
+    // that's bigger than the whole budget on its own isn't cached at all.
+    void insert(const Key& key, std::shared_ptr<const PreparedImpulseResponse> impulseResponse);
+
+    // the same again, for spectra. only complete ones should go in.
+    std::shared_ptr<const PartitionedConvolver::Spectra> getSpectra(const SpectraKey& key);
+    void insertSpectra(const SpectraKey& key, std::shared_ptr<const PartitionedConvolver::Spectra> spectra);
+
+    void setMaximumSize(size_t newMaximumSizeInBytes);
+    size_t getMaximumSize() const;
+    size_t getCurrentSize() const;
+    void clear();
+
+private:
+    // an entry holds either an IR or some spectra, and is in the index that goes with it.
+    struct Entry
+    {
+        Key key;
+        std::shared_ptr<const PreparedImpulseResponse> impulseResponse;
+        SpectraKey spectraKey;
+        std::shared_ptr<const PartitionedConvolver::Spectra> spectra;
+        size_t sizeInBytes = 0;
+    };
+
+    void erase(std::list<Entry>::iterator entry);
+    void add(Entry entry);
+    void evictUntilWithinBudget();
+
+    mutable juce::CriticalSection lock;
+
+    // front of the list is the most recently used entry.
+    std::list<Entry> entries;
+    std::map<Key, std::list<Entry>::iterator> index;
+    std::map<SpectraKey, std::list<Entry>::iterator> spectraIndex;
+
+    size_t currentSize = 0;
+    size_t maximumSize = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ImpulseResponseCache)
+};
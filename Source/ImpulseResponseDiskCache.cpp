@@ -0,0 +1,277 @@
+/*
+  ==============================================================================
+    ImpulseResponseDiskCache.cpp
+    Created: 17 Oct 2026
+  ==============================================================================
+*/
+
+#include "ImpulseResponseDiskCache.h"
+
+namespace
+{
+    // the on-disk header. everything is stored in the machine's native (little-endian) order --
+    // the cache never leaves the machine that wrote it.
+    struct FileHeader
+    {
+        char magic[4];
+        juce::uint32 formatVersion;
+        juce::uint32 contentVersion;
+
+        juce::int32 decayTimeMs;
+        // this was the proximity, before it stopped being part of the IR. files from then have
+        // zero here, which no real floor is, so they never match.
+        juce::int32 noiseFloorDecibels;
+        juce::int32 reverse;
+        juce::int32 sampleRateHz;
+        juce::int32 qualityMode;
+        juce::uint32 seed;
+
+        juce::int32 numChannels;
+        juce::int32 numSamples;
+
+        // this was a reserved (always zero) field before true stereo came along, so older files
+        // still read correctly as plain stereo.
+        juce::int32 trueStereo;
+
+        double loadSampleRate;
+        juce::uint64 payloadChecksum;
+    };
+
+    static_assert(sizeof(FileHeader) == 64, "the header layout is part of the file format");
+
+    constexpr char fileMagic[4] = { 'S', 'G', 'I', 'R' };
+
+    FileHeader makeHeader(const ImpulseResponseCache::Key& key, int numChannels, int numSamples, double loadSampleRate)
+    {
+        FileHeader header {};
+        std::memcpy(header.magic, fileMagic, sizeof(fileMagic));
+        header.formatVersion = ImpulseResponseDiskCache::formatVersion;
+        header.contentVersion = ImpulseResponseDiskCache::contentVersion;
+        header.decayTimeMs = key.decayTimeMs;
+        header.reverse = key.reverse ? 1 : 0;
+        header.sampleRateHz = key.sampleRateHz;
+        header.qualityMode = key.qualityMode;
+        header.seed = key.seed;
+        header.trueStereo = key.trueStereo ? 1 : 0;
+        header.noiseFloorDecibels = key.noiseFloorDecibels;
+        header.numChannels = numChannels;
+        header.numSamples = numSamples;
+        header.loadSampleRate = loadSampleRate;
+        return header;
+    }
+
+    // a quick FNV-style hash over 64-bit words -- plenty to catch truncated or corrupted files,
+    // and fast enough to run over a whole IR on every load.
+    juce::uint64 hashBytes(const void* data, size_t numBytes)
+    {
+        auto* bytes = static_cast<const juce::uint8*>(data);
+        juce::uint64 hash = 0xcbf29ce484222325ULL;
+
+        size_t i = 0;
+        for (; i + 8 <= numBytes; i += 8)
+        {
+            juce::uint64 word;
+            std::memcpy(&word, bytes + i, sizeof(word));
+            hash = (hash ^ word) * 0x100000001b3ULL;
+            hash ^= hash >> 32;
+        }
+
+        for (; i < numBytes; ++i)
+            hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+
+        return hash;
+    }
+
+    // each channel is hashed on its own and the results are chained, so we never need the whole
+    // payload in one contiguous block to work it out.
+    juce::uint64 calculateChecksum(const float* const* channels, int numChannels, int numSamples)
+    {
+        juce::uint64 checksum = 0;
+        for (int c = 0; c < numChannels; ++c)
+            checksum = (checksum ^ hashBytes(channels[c], (size_t) numSamples * sizeof(float))) * 0x100000001b3ULL;
+
+        return checksum;
+    }
+}
+
+ImpulseResponseDiskCache::ImpulseResponseDiskCache()
+    : ImpulseResponseDiskCache(getDefaultDirectory(), defaultMaximumSizeInBytes)
+{
+}
+
+ImpulseResponseDiskCache::ImpulseResponseDiskCache(const juce::File& cacheDirectory, juce::int64 maximumSizeInBytes)
+    : directory(cacheDirectory),
+      maximumSize(maximumSizeInBytes)
+{
+}
+
+juce::File ImpulseResponseDiskCache::getDefaultDirectory()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile("SilkForest")
+        .getChildFile("SilkGhost")
+        .getChildFile("IRCache");
+}
+
+juce::File ImpulseResponseDiskCache::getFileFor(const ImpulseResponseCache::Key& key) const
+{
+    const auto name = "ir_" + juce::String(key.decayTimeMs)
+                    + "_" + juce::String(key.reverse ? 1 : 0)
+                    + "_" + juce::String(key.sampleRateHz)
+                    + "_" + juce::String(key.qualityMode)
+                    + "_" + juce::String::toHexString((juce::int64) key.seed)
+                    + (key.trueStereo ? "_ts" : "")
+                    + "_nf" + juce::String(-key.noiseFloorDecibels)
+                    + ".sgir";
+
+    return directory.getChildFile(name);
+}
+
+std::shared_ptr<const PreparedImpulseResponse> ImpulseResponseDiskCache::load(const ImpulseResponseCache::Key& key)
+{
+    if (! isEnabled())
+        return nullptr;
+
+    const auto file = getFileFor(key);
+    if (! file.existsAsFile())
+        return nullptr;
+
+    auto mapped = std::make_shared<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+
+    // the mapping has to go first, or the file can't be deleted on Windows.
+    auto rejectFile = [&file, &mapped]
+    {
+        DBG("Discarding invalid IR cache file: " + file.getFullPathName());
+        mapped.reset();
+        file.deleteFile();
+        return nullptr;
+    };
+
+    if (mapped->getData() == nullptr || mapped->getSize() < sizeof(FileHeader))
+        return rejectFile();
+
+    FileHeader header;
+    std::memcpy(&header, mapped->getData(), sizeof(header));
+
+    const auto expected = makeHeader(key, header.numChannels, header.numSamples, header.loadSampleRate);
+    const bool headerMatches = std::memcmp(header.magic, fileMagic, sizeof(fileMagic)) == 0
+                            && header.formatVersion == expected.formatVersion
+                            && header.contentVersion == expected.contentVersion
+                            && header.decayTimeMs == expected.decayTimeMs
+                            && header.reverse == expected.reverse
+                            && header.sampleRateHz == expected.sampleRateHz
+                            && header.qualityMode == expected.qualityMode
+                            && header.seed == expected.seed
+                            && header.trueStereo == expected.trueStereo
+                            && header.noiseFloorDecibels == expected.noiseFloorDecibels
+                            && header.numChannels > 0 && header.numSamples > 0
+                            && header.loadSampleRate > 0.0;
+
+    if (! headerMatches)
+        return rejectFile();
+
+    const auto payloadSize = (size_t) header.numChannels * (size_t) header.numSamples * sizeof(float);
+    if (mapped->getSize() != sizeof(FileHeader) + payloadSize)
+        return rejectFile();
+
+    // the buffer refers straight into the mapped pages (which is why it's only ever handed out
+    // as const), and the prepared IR keeps the mapping alive for as long as it's around.
+    auto* payload = const_cast<float*>(reinterpret_cast<const float*>(static_cast<const char*>(mapped->getData()) + sizeof(FileHeader)));
+
+    std::vector<float*> channels;
+    for (int c = 0; c < header.numChannels; ++c)
+        channels.push_back(payload + (size_t) c * (size_t) header.numSamples);
+
+    if (calculateChecksum(channels.data(), header.numChannels, header.numSamples) != header.payloadChecksum)
+        return rejectFile();
+
+    auto prepared = std::make_shared<PreparedImpulseResponse>();
+    prepared->buffer = juce::AudioBuffer<float>(channels.data(), header.numChannels, header.numSamples);
+    prepared->sampleRate = header.loadSampleRate;
+    prepared->mappedFile = std::move(mapped);
+
+    // mark it as recently used so trimming keeps it around.
+    file.setLastModificationTime(juce::Time::getCurrentTime());
+
+    return prepared;
+}
+
+bool ImpulseResponseDiskCache::store(const ImpulseResponseCache::Key& key, const PreparedImpulseResponse& impulseResponse)
+{
+    if (! isEnabled())
+        return false;
+
+    const auto& buffer = impulseResponse.buffer;
+    const int numChannels = buffer.getNumChannels();
+    const int numSamples = buffer.getNumSamples();
+    if (numChannels == 0 || numSamples == 0)
+        return false;
+
+    const juce::ScopedLock sl(writeLock);
+
+    if (! directory.createDirectory())
+        return false;
+
+    const auto target = getFileFor(key);
+    const auto channelSize = (size_t) numSamples * sizeof(float);
+
+    auto header = makeHeader(key, numChannels, numSamples, impulseResponse.sampleRate);
+    header.payloadChecksum = calculateChecksum(buffer.getArrayOfReadPointers(), numChannels, numSamples);
+
+    juce::TemporaryFile temp(target);
+    {
+        juce::FileOutputStream out(temp.getFile());
+        if (! out.openedOk())
+            return false;
+
+        bool ok = out.write(&header, sizeof(header));
+        for (int c = 0; c < numChannels && ok; ++c)
+            ok = out.write(buffer.getReadPointer(c), channelSize);
+
+        out.flush();
+        if (! ok || out.getStatus().failed())
+            return false;
+    }
+
+    if (! temp.overwriteTargetFileWithTemporary())
+        return false;
+
+    trimToMaximumSize();
+    return true;
+}
+
+void ImpulseResponseDiskCache::setMaximumSize(juce::int64 newMaximumSizeInBytes)
+{
+    maximumSize = newMaximumSizeInBytes;
+
+    const juce::ScopedLock sl(writeLock);
+    trimToMaximumSize();
+}
+
+void ImpulseResponseDiskCache::trimToMaximumSize()
+{
+    auto files = directory.findChildFiles(juce::File::findFiles, false, "*.sgir");
+
+    juce::int64 totalSize = 0;
+    for (auto& f : files)
+        totalSize += f.getSize();
+
+    if (totalSize <= maximumSize.load())
+        return;
+
+    // oldest first -- loads bump the modification time, so this is least recently used order.
+    std::sort(files.begin(), files.end(), [](const juce::File& a, const juce::File& b)
+    {
+        return a.getLastModificationTime() < b.getLastModificationTime();
+    });
+
+    for (auto& f : files)
+    {
+        if (totalSize <= maximumSize.load())
+            break;
+
+        const auto size = f.getSize();
+        if (f.deleteFile())
+            totalSize -= size;
+    }
+}
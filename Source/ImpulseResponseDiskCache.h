@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+    ImpulseResponseDiskCache.h
+    Created: 17 Oct 2026
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ImpulseResponseCache.h"
+
+// a persistent cache of prepared IRs on disk, shared by every SilkGhost instance on the machine.
+// opening a session with dozens of instances used to mean re-synthesising every single IR in
+// prepareToPlay -- with this, a warm load just memory-maps the finished IR and skips synthesis
+// entirely.
+//
+// each entry is a single file: a fixed 64-byte header (magic, format and content versions, the
+// full cache key, the buffer dimensions and a checksum of the payload) followed by the raw
+// float samples, channel after channel. files are mapped read-only, so the IR data is paged in
+// by the OS rather than copied onto the heap, and anything that doesn't match exactly -- wrong
+// version, wrong key, truncated, or failing the checksum -- is treated as a miss and deleted.
+//
+// the directory is kept under a size cap by throwing out the least recently used files.
+class ImpulseResponseDiskCache
+{
+public:
+    // the format of the files themselves.
+    static constexpr juce::uint32 formatVersion = 1;
+
+    // bump this whenever the synthesis or preparation of an IR changes, so that files written by
+    // an older build stop matching and get rebuilt.
+    static constexpr juce::uint32 contentVersion = 5;
+
+    static constexpr juce::int64 defaultMaximumSizeInBytes = (juce::int64) 2 * 1024 * 1024 * 1024;
+
+    // uses the default location (inside the user's application data folder) and size cap.
+    ImpulseResponseDiskCache();
+    ImpulseResponseDiskCache(const juce::File& directory, juce::int64 maximumSizeInBytes);
+
+    static juce::File getDefaultDirectory();
+
+    // maps the entry for this key, or returns nullptr if there isn't a valid one.
+    std::shared_ptr<const PreparedImpulseResponse> load(const ImpulseResponseCache::Key& key);
+
+    // writes an entry (via a temporary file, so a half-written file is never visible), then
+    // trims the directory back under the size cap. returns false if the write failed.
+    bool store(const ImpulseResponseCache::Key& key, const PreparedImpulseResponse& impulseResponse);
+
+    // the cache is optional -- when disabled, load always misses and store does nothing.
+    void setEnabled(bool shouldBeEnabled) { enabled = shouldBeEnabled; }
+    bool isEnabled() const { return enabled.load(); }
+
+    void setMaximumSize(juce::int64 newMaximumSizeInBytes);
+
+private:
+    juce::File getFileFor(const ImpulseResponseCache::Key& key) const;
+    void trimToMaximumSize();
+
+    const juce::File directory;
+    std::atomic<juce::int64> maximumSize;
+    std::atomic<bool> enabled { true };
+
+    // serialises writing and trimming between instances in the same process.
+    juce::CriticalSection writeLock;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ImpulseResponseDiskCache)
+};
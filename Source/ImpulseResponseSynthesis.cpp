@@ -0,0 +1,462 @@
+/*
+  ==============================================================================
+    ImpulseResponseSynthesis.cpp
+    Created: 17 Oct 2026
+  ==============================================================================
+*/
+
+#include "ImpulseResponseSynthesis.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+
+ // the AVX2 kernel gets compiled for AVX2 even though the rest of the plugin isn't -- we only
+ // ever call it after checking the CPU supports it.
+ #if JUCE_MSVC
+  #define SILKGHOST_TARGET_AVX2
+ #else
+  #define SILKGHOST_TARGET_AVX2 __attribute__ ((target ("avx2")))
+ #endif
+#endif
+
+namespace ImpulseResponseSynthesis
+{
+namespace
+{
+    // every kernel works on eight interleaved lanes, so sample i always lands in lane i % 8.
+    // SSE2 does that as two halves, AVX2 in one go, and the scalar path loops over them -- the
+    // arithmetic is the same in each case, so they all produce the same numbers.
+    constexpr int numLanes = 8;
+
+    // how often we re-anchor the envelope and LFO recurrences against the exact values. the
+    // recurrences drift a tiny bit with every step, so this keeps the error well below anything
+    // audible while only calling std::exp/std::sin a handful of times per chunk.
+    constexpr int chunkSize = 1024;
+
+    // the lane-wise state for one chunk. the envelope lanes already include the late gain.
+    struct ChunkState
+    {
+        alignas(32) float envelope[numLanes];
+        alignas(32) float sine[numLanes];
+        alignas(32) float cosine[numLanes];
+        alignas(32) juce::uint32 index[numLanes];
+
+        // multipliers that advance every lane by numLanes samples.
+        float envelopeStep = 1.0f;
+        float sineStep = 0.0f;
+        float cosineStep = 1.0f;
+
+        float depth = 0.0f;
+
+        // the two halves of the noise key, derived from the seed.
+        juce::uint32 key0 = 0, key1 = 0;
+    };
+
+    // a cheap, well-mixed 32-bit bijection (the "lowbias32" integer hash).
+    inline juce::uint32 mixBits(juce::uint32 x)
+    {
+        x ^= x >> 16;
+        x *= 0x7feb352dU;
+        x ^= x >> 15;
+        x *= 0x846ca68bU;
+        x ^= x >> 16;
+        return x;
+    }
+
+    // the noise is counter-based: sample i's value is a hash of (key, i), with no state carried
+    // from one sample to the next. that's what lets us cut the tail into any number of pieces,
+    // render them on any number of threads, and still get the same bits. the hash result is
+    // mapped onto [-0.5, 0.5) by stuffing its top 23 bits into the mantissa of a float in [1, 2),
+    // the same distribution as (nextFloat() * 2 - 1) * 0.5.
+    inline float noiseAt(juce::uint32 index, juce::uint32 key0, juce::uint32 key1)
+    {
+        const juce::uint32 x = mixBits(mixBits(index ^ key0) ^ key1);
+
+        const juce::uint32 bits = (x >> 9) | 0x3f800000U;
+        float f;
+        std::memcpy(&f, &bits, sizeof(f));
+        return f - 1.5f;
+    }
+
+    float processChunkScalar(float* out, int numSamples, ChunkState& s)
+    {
+        float peak = 0.0f;
+
+        for (int i = 0; i < numSamples; i += numLanes)
+        {
+            for (int lane = 0; lane < numLanes; ++lane)
+            {
+                const float noise = noiseAt(s.index[lane], s.key0, s.key1);
+                const float mod = 1.0f + s.depth * s.sine[lane];
+                const float value = (noise * s.envelope[lane]) * mod;
+
+                out[i + lane] = value;
+                peak = juce::jmax(peak, std::abs(value));
+
+                s.envelope[lane] *= s.envelopeStep;
+                s.index[lane] += (juce::uint32) numLanes;
+
+                const float sine = s.sine[lane] * s.cosineStep + s.cosine[lane] * s.sineStep;
+                const float cosine = s.cosine[lane] * s.cosineStep - s.sine[lane] * s.sineStep;
+                s.sine[lane] = sine;
+                s.cosine[lane] = cosine;
+            }
+        }
+
+        return peak;
+    }
+
+   #if JUCE_INTEL
+    // SSE2 has no 32-bit low multiply, so we build one out of two 32x32->64 multiplies.
+    inline __m128i multiplyLowSSE2(__m128i a, __m128i b)
+    {
+        const __m128i even = _mm_mul_epu32(a, b);
+        const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                  _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+    }
+
+    inline __m128i mixBitsSSE2(__m128i x)
+    {
+        x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+        x = multiplyLowSSE2(x, _mm_set1_epi32(0x7feb352d));
+        x = _mm_xor_si128(x, _mm_srli_epi32(x, 15));
+        x = multiplyLowSSE2(x, _mm_set1_epi32((int) 0x846ca68bU));
+        x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+        return x;
+    }
+
+    inline __m128 noiseAtSSE2(__m128i index, __m128i key0, __m128i key1)
+    {
+        const __m128i x = mixBitsSSE2(_mm_xor_si128(mixBitsSSE2(_mm_xor_si128(index, key0)), key1));
+        const __m128i bits = _mm_or_si128(_mm_srli_epi32(x, 9), _mm_set1_epi32(0x3f800000));
+        return _mm_sub_ps(_mm_castsi128_ps(bits), _mm_set1_ps(1.5f));
+    }
+
+    float processChunkSSE2(float* out, int numSamples, ChunkState& s)
+    {
+        const __m128 envelopeStep = _mm_set1_ps(s.envelopeStep);
+        const __m128 sineStep = _mm_set1_ps(s.sineStep);
+        const __m128 cosineStep = _mm_set1_ps(s.cosineStep);
+        const __m128 depth = _mm_set1_ps(s.depth);
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+
+        __m128 envelope[2] = { _mm_load_ps(s.envelope), _mm_load_ps(s.envelope + 4) };
+        __m128 sine[2]     = { _mm_load_ps(s.sine), _mm_load_ps(s.sine + 4) };
+        __m128 cosine[2]   = { _mm_load_ps(s.cosine), _mm_load_ps(s.cosine + 4) };
+        __m128i index[2]   = { _mm_load_si128((const __m128i*) s.index), _mm_load_si128((const __m128i*) (s.index + 4)) };
+        const __m128i key0 = _mm_set1_epi32((int) s.key0);
+        const __m128i key1 = _mm_set1_epi32((int) s.key1);
+        const __m128i indexStep = _mm_set1_epi32(numLanes);
+        __m128 peak = _mm_setzero_ps();
+
+        for (int i = 0; i < numSamples; i += numLanes)
+        {
+            for (int half = 0; half < 2; ++half)
+            {
+                const __m128 n = noiseAtSSE2(index[half], key0, key1);
+                const __m128 mod = _mm_add_ps(one, _mm_mul_ps(depth, sine[half]));
+                const __m128 value = _mm_mul_ps(_mm_mul_ps(n, envelope[half]), mod);
+
+                _mm_store_ps(out + i + half * 4, value);
+                peak = _mm_max_ps(peak, _mm_and_ps(value, absMask));
+
+                envelope[half] = _mm_mul_ps(envelope[half], envelopeStep);
+                index[half] = _mm_add_epi32(index[half], indexStep);
+
+                const __m128 newSine = _mm_add_ps(_mm_mul_ps(sine[half], cosineStep), _mm_mul_ps(cosine[half], sineStep));
+                const __m128 newCosine = _mm_sub_ps(_mm_mul_ps(cosine[half], cosineStep), _mm_mul_ps(sine[half], sineStep));
+                sine[half] = newSine;
+                cosine[half] = newCosine;
+            }
+        }
+
+        _mm_store_ps(s.envelope, envelope[0]);  _mm_store_ps(s.envelope + 4, envelope[1]);
+        _mm_store_ps(s.sine, sine[0]);          _mm_store_ps(s.sine + 4, sine[1]);
+        _mm_store_ps(s.cosine, cosine[0]);      _mm_store_ps(s.cosine + 4, cosine[1]);
+        _mm_store_si128((__m128i*) s.index, index[0]);
+        _mm_store_si128((__m128i*) (s.index + 4), index[1]);
+
+        alignas(16) float lanes[4];
+        _mm_store_ps(lanes, peak);
+        return juce::jmax(lanes[0], lanes[1], juce::jmax(lanes[2], lanes[3]));
+    }
+
+    SILKGHOST_TARGET_AVX2 inline __m256i mixBitsAVX2(__m256i x)
+    {
+        x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+        x = _mm256_mullo_epi32(x, _mm256_set1_epi32(0x7feb352d));
+        x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 15));
+        x = _mm256_mullo_epi32(x, _mm256_set1_epi32((int) 0x846ca68bU));
+        x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+        return x;
+    }
+
+    SILKGHOST_TARGET_AVX2 float processChunkAVX2(float* out, int numSamples, ChunkState& s)
+    {
+        const __m256 envelopeStep = _mm256_set1_ps(s.envelopeStep);
+        const __m256 sineStep = _mm256_set1_ps(s.sineStep);
+        const __m256 cosineStep = _mm256_set1_ps(s.cosineStep);
+        const __m256 depth = _mm256_set1_ps(s.depth);
+        const __m256 one = _mm256_set1_ps(1.0f);
+        const __m256 half = _mm256_set1_ps(1.5f);
+        const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+        const __m256i exponent = _mm256_set1_epi32(0x3f800000);
+
+        __m256 envelope = _mm256_load_ps(s.envelope);
+        __m256 sine = _mm256_load_ps(s.sine);
+        __m256 cosine = _mm256_load_ps(s.cosine);
+        __m256i index = _mm256_load_si256((const __m256i*) s.index);
+        const __m256i key0 = _mm256_set1_epi32((int) s.key0);
+        const __m256i key1 = _mm256_set1_epi32((int) s.key1);
+        const __m256i indexStep = _mm256_set1_epi32(numLanes);
+        __m256 peak = _mm256_setzero_ps();
+
+        for (int i = 0; i < numSamples; i += numLanes)
+        {
+            const __m256i hash = mixBitsAVX2(_mm256_xor_si256(mixBitsAVX2(_mm256_xor_si256(index, key0)), key1));
+            const __m256i bits = _mm256_or_si256(_mm256_srli_epi32(hash, 9), exponent);
+            const __m256 n = _mm256_sub_ps(_mm256_castsi256_ps(bits), half);
+            const __m256 mod = _mm256_add_ps(one, _mm256_mul_ps(depth, sine));
+            const __m256 value = _mm256_mul_ps(_mm256_mul_ps(n, envelope), mod);
+
+            _mm256_store_ps(out + i, value);
+            peak = _mm256_max_ps(peak, _mm256_and_ps(value, absMask));
+
+            envelope = _mm256_mul_ps(envelope, envelopeStep);
+            index = _mm256_add_epi32(index, indexStep);
+
+            const __m256 newSine = _mm256_add_ps(_mm256_mul_ps(sine, cosineStep), _mm256_mul_ps(cosine, sineStep));
+            const __m256 newCosine = _mm256_sub_ps(_mm256_mul_ps(cosine, cosineStep), _mm256_mul_ps(sine, sineStep));
+            sine = newSine;
+            cosine = newCosine;
+        }
+
+        _mm256_store_ps(s.envelope, envelope);
+        _mm256_store_ps(s.sine, sine);
+        _mm256_store_ps(s.cosine, cosine);
+        _mm256_store_si256((__m256i*) s.index, index);
+
+        alignas(32) float lanes[8];
+        _mm256_store_ps(lanes, peak);
+
+        float result = 0.0f;
+        for (auto lane : lanes)
+            result = juce::jmax(result, lane);
+
+        return result;
+    }
+   #endif
+}
+
+Instructions getBestAvailableInstructions()
+{
+   #if JUCE_INTEL
+    static const auto best = juce::SystemStats::hasAVX2() ? Instructions::avx2
+                           : juce::SystemStats::hasSSE2() ? Instructions::sse2
+                                                          : Instructions::scalar;
+    return best;
+   #else
+    return Instructions::scalar;
+   #endif
+}
+
+float renderLateTail(float* dest, int startSample, int numSamples,
+                     const LateTailParameters& parameters, juce::uint32 seed, bool reversed,
+                     Instructions instructions)
+{
+    if (numSamples <= 0)
+        return 0.0f;
+
+    auto* processChunk = &processChunkScalar;
+
+   #if JUCE_INTEL
+    if (instructions == Instructions::avx2)
+        processChunk = &processChunkAVX2;
+    else if (instructions == Instructions::sse2)
+        processChunk = &processChunkSSE2;
+   #else
+    juce::ignoreUnused(instructions);
+   #endif
+
+    // the envelope is exp(-6.91 * t / decayTime) and the LFO is sin(2 * pi * rate * t), both with
+    // t = i / sampleRate. per sample, that's a constant ratio and a constant rotation. with no
+    // decay time the envelope stays flat, for when the decay gets applied later on.
+    const double decayPerSample = parameters.decayTime > 0.0f ? 6.91 / ((double) parameters.decayTime * parameters.sampleRate) : 0.0;
+    const double phasePerSample = juce::MathConstants<double>::twoPi * parameters.modulationRate / parameters.sampleRate;
+
+    ChunkState state;
+    state.envelopeStep = (float) std::exp(-decayPerSample * numLanes);
+    state.sineStep = (float) std::sin(phasePerSample * numLanes);
+    state.cosineStep = (float) std::cos(phasePerSample * numLanes);
+    state.depth = parameters.modulationDepth;
+
+    state.key0 = mixBits(seed);
+    state.key1 = mixBits(seed ^ 0x9e3779b9U);
+
+    alignas(32) float scratch[chunkSize];
+    float peak = 0.0f;
+
+    for (int done = 0; done < numSamples; done += chunkSize)
+    {
+        const int numThisTime = juce::jmin(chunkSize, numSamples - done);
+        const int numRounded = (numThisTime + numLanes - 1) & ~(numLanes - 1);
+        const double firstIndex = (double) startSample + done;
+
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            const double index = firstIndex + lane;
+            state.envelope[lane] = (float) (parameters.gain * std::exp(-decayPerSample * index));
+            state.sine[lane] = (float) std::sin(phasePerSample * index);
+            state.cosine[lane] = (float) std::cos(phasePerSample * index);
+            state.index[lane] = (juce::uint32) (startSample + done + lane);
+        }
+
+        const float chunkPeak = processChunk(scratch, numRounded, state);
+
+        // the last chunk can run a few samples past the end, so only count what we keep.
+        if (numRounded == numThisTime)
+            peak = juce::jmax(peak, chunkPeak);
+        else
+            for (int i = 0; i < numThisTime; ++i)
+                peak = juce::jmax(peak, std::abs(scratch[i]));
+
+        if (reversed)
+            std::reverse_copy(scratch, scratch + numThisTime, dest + numSamples - done - numThisTime);
+        else
+            std::copy(scratch, scratch + numThisTime, dest + done);
+    }
+
+    return peak;
+}
+
+WorkerPool::WorkerPool()
+    : WorkerPool(juce::SystemStats::getNumCpus())
+{
+}
+
+WorkerPool::WorkerPool(int numThreads)
+    : pool(juce::ThreadPoolOptions()
+         .withThreadName("SilkGhost IR Workers")
+         .withNumberOfThreads(juce::jmax(1, numThreads - 1))
+         .withThreadStackSizeBytes(juce::Thread::osDefaultStackSize)
+         .withDesiredThreadPriority(juce::Thread::Priority::normal)),
+      numHelpers(juce::jmax(0, numThreads - 1))
+{
+}
+
+void WorkerPool::parallelFor(int numTasks, const std::function<void(int)>& task)
+{
+    if (numTasks <= 0)
+        return;
+
+    // tasks are handed out from a shared counter, so whoever's free grabs the next one. the
+    // state is reference counted because a helper can get scheduled after we've already
+    // returned -- by then there's nothing left for it to claim, so it just drops out.
+    struct SharedState
+    {
+        std::atomic<int> nextTask { 0 };
+        std::atomic<int> tasksRemaining { 0 };
+        juce::WaitableEvent finished;
+    };
+
+    auto state = std::make_shared<SharedState>();
+    state->tasksRemaining = numTasks;
+
+    auto runTasks = [state, numTasks, &task]
+    {
+        for (;;)
+        {
+            const int index = state->nextTask++;
+            if (index >= numTasks)
+                return;
+
+            task(index);
+
+            if (--state->tasksRemaining == 0)
+                state->finished.signal();
+        }
+    };
+
+    const int numHelpersNeeded = juce::jmin(numHelpers, numTasks - 1);
+    for (int i = 0; i < numHelpersNeeded; ++i)
+        pool.addJob(runTasks);
+
+    runTasks();
+    state->finished.wait();
+}
+
+std::optional<float> renderLateTailParallel(WorkerPool& workers, juce::AudioBuffer<float>& ir,
+                                            int startSample, const LateTailParameters& parameters,
+                                            juce::uint32 seed, bool reversed,
+                                            const std::function<bool()>& shouldCancel)
+{
+    const int length = ir.getNumSamples();
+    const int numChannels = ir.getNumChannels();
+    if (startSample >= length || numChannels == 0)
+        return 0.0f;
+
+    // 64k samples is big enough that handing out a slice costs next to nothing, and small
+    // enough that a 20s IR still splits into plenty of pieces to go round.
+    constexpr int sliceSize = 1 << 16;
+    const int slicesPerChannel = (length - startSample + sliceSize - 1) / sliceSize;
+    const int numTasks = slicesPerChannel * numChannels;
+
+    std::vector<float*> channels;
+    for (int c = 0; c < numChannels; ++c)
+        channels.push_back(ir.getWritePointer(c));
+
+    std::vector<float> peaks((size_t) numTasks, 0.0f);
+    std::atomic<bool> cancelled { false };
+
+    workers.parallelFor(numTasks, [&](int task)
+    {
+        if (cancelled.load() || (shouldCancel != nullptr && shouldCancel()))
+        {
+            cancelled = true;
+            return;
+        }
+
+        const int channel = task / slicesPerChannel;
+        const int start = startSample + (task % slicesPerChannel) * sliceSize;
+        const int numSamples = juce::jmin(sliceSize, length - start);
+
+        auto* data = channels[(size_t) channel];
+        auto* dest = reversed ? data + length - start - numSamples : data + start;
+        peaks[(size_t) task] = renderLateTail(dest, start, numSamples, parameters, seed + (juce::uint32) channel, reversed);
+    });
+
+    if (cancelled.load())
+        return std::nullopt;
+
+    return *std::max_element(peaks.begin(), peaks.end());
+}
+
+int findNoiseFloorLength(const juce::AudioBuffer<float>& ir, double sampleRate, float floorDecibels,
+                         int decayStart, float decayTime)
+{
+    const int length = ir.getNumSamples();
+    const auto floor = juce::Decibels::decibelsToGain(floorDecibels, -1000.0f);
+
+    // 10ms windows are short enough to follow the decay closely, and long enough that a single
+    // quiet stretch of noise can't pass for the end of the tail. we work back from the end, so
+    // a long tail that's mostly above the floor only costs a window or two.
+    const int windowSize = juce::jmax(1, (int) (sampleRate * 0.01));
+    const double decayRate = decayTime > 0.0f ? 6.91 / (decayTime * sampleRate) : 0.0;
+
+    for (int end = length; end > 0; end -= windowSize)
+    {
+        const int start = juce::jmax(0, end - windowSize);
+
+        // the envelope is at its loudest at the start of the window, so that's what we go by.
+        const auto envelope = decayRate > 0.0 && start >= decayStart ? (float) std::exp(-decayRate * start) : 1.0f;
+
+        for (int c = 0; c < ir.getNumChannels(); ++c)
+            if (ir.getMagnitude(c, start, end - start) * envelope >= floor)
+                return end;
+    }
+
+    return 0;
+}
+}
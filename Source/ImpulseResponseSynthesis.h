@@ -0,0 +1,90 @@
+/*
+  ==============================================================================
+    ImpulseResponseSynthesis.h
+    Created: 17 Oct 2026
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// the heavy lifting behind createReverbImpulseResponse. the late tail is where nearly all the
+// work goes when building an IR (20s at 192kHz is almost 4 million samples per channel!), so
+// instead of calling std::exp, std::sin and the system RNG for every sample and then making a
+// handful of extra passes, we generate noise, decay envelope and modulation together in a
+// single pass. there are SSE2 and AVX2 versions of the kernel, picked at runtime.
+namespace ImpulseResponseSynthesis
+{
+    struct LateTailParameters
+    {
+        double sampleRate = 44100.0;
+        float decayTime = 1.0f;         // seconds until the envelope hits ~-60 dB, or 0 for no decay at all.
+        float gain = 1.0f;              // an overall gain on the tail.
+        float modulationDepth = 0.05f;  // 5% amplitude variation.
+        float modulationRate = 0.1f;    // slow modulation rate, 0.1 Hz.
+    };
+
+    enum class Instructions
+    {
+        scalar,
+        sse2,
+        avx2
+    };
+
+    // the widest instruction set this machine can run.
+    Instructions getBestAvailableInstructions();
+
+    // renders samples [startSample, startSample + numSamples) of one channel of the late tail,
+    // where sample indices are measured from the very start of the IR. dest[0] receives
+    // startSample -- or, if reversed is set, the block is written back to front so that
+    // dest[numSamples - 1] does. the return value is the peak magnitude that was written.
+    //
+    // the noise is counter-based -- every sample is a hash of (seed, sample index) -- so any
+    // slice of the tail can be rendered on its own, in any order, and always comes out the
+    // same, whichever kernel ends up running it.
+    float renderLateTail(float* dest, int startSample, int numSamples,
+                         const LateTailParameters& parameters, juce::uint32 seed, bool reversed,
+                         Instructions instructions = getBestAvailableInstructions());
+
+    // a pool of worker threads shared by every SilkGhost instance in the process (hold one with
+    // a juce::SharedResourcePointer for as long as you'll be building IRs), so a session full of
+    // instances doesn't end up with a full set of threads each, and nobody starts and stops
+    // them on every build.
+    class WorkerPool
+    {
+    public:
+        // one thread per core, the calling thread included.
+        WorkerPool();
+
+        // numThreads counts the calling thread, so a pool of one runs everything on the caller.
+        explicit WorkerPool(int numThreads);
+
+        // runs task(0) .. task(numTasks - 1) across the workers and the calling thread, and
+        // returns once every one of them has finished.
+        void parallelFor(int numTasks, const std::function<void(int)>& task);
+
+    private:
+        juce::ThreadPool pool;
+        const int numHelpers;
+
+        JUCE_DECLARE_NON_COPYABLE(WorkerPool)
+    };
+
+    // renders the late tail of every channel of ir from startSample to the end, cut into
+    // fixed-size slices and fanned out across workers. channel c uses seed + c. the
+    // slicing never depends on how many threads we get, so the result is bit-identical on any
+    // machine. returns the peak magnitude written, or nothing if shouldCancel fired first.
+    std::optional<float> renderLateTailParallel(WorkerPool& workers, juce::AudioBuffer<float>& ir,
+                                                int startSample, const LateTailParameters& parameters,
+                                                juce::uint32 seed, bool reversed,
+                                                const std::function<bool()>& shouldCancel);
+
+    // measures how an IR's level falls away, in short windows, and returns how many samples of
+    // it there are before it drops below floorDecibels (relative to full scale) for good --
+    // everything after that can be thrown away. if decayTime is given, the level is measured as
+    // it'd be with the same envelope as the late tail (from the start of the IR) put on
+    // everything from decayStart on, the way the convolution engine does it.
+    int findNoiseFloorLength(const juce::AudioBuffer<float>& ir, double sampleRate, float floorDecibels,
+                             int decayStart = 0, float decayTime = 0.0f);
+}
@@ -0,0 +1,1723 @@
+/*
+  ==============================================================================
+    PartitionedConvolver.cpp
+    Created: 17 Oct 2026
+  ==============================================================================
+*/
+
+#include "PartitionedConvolver.h"
+
+// runs one stage for the worker pool. there's one of these per stage, reused every time it runs.
+class PartitionedConvolver::StageTask : public ConvolutionWorkerPool::Task
+{
+public:
+    StageTask(PartitionedConvolver& o, Stage& s) : owner(o), stage(s) {}
+
+    void run() noexcept override { owner.runStage(stage, time, gains); }
+
+    // taken when the run is submitted, so the audio thread is free to move on.
+    juce::int64 time = 0;
+    StageGains gains;
+
+private:
+    PartitionedConvolver& owner;
+    Stage& stage;
+};
+
+// a stage's partition spectra, kept apart from the rest of it so they can be shared (see
+// Spectra). they're stored as interleaved (re, im) pairs, which is the layout JUCE's real-only
+// FFT hands back -- blockSize + 1 of them per partition.
+struct PartitionedConvolver::Spectra::StageSpectra
+{
+    // the part of the IR they're for, so a stage can tell whether they're the ones it needs.
+    int offset = 0;
+    int blockSize = 0;
+    int numPartitions = 0;
+
+    // the partition spectra, one run of numPartitions * numBins per IR channel.
+    std::vector<std::vector<float>> impulseResponse;
+
+    // stages from the decay start on hold the tail with no decay on it (see setDecayTime), and
+    // every partition there gets a ramp spectrum too -- the same samples, weighted by how far
+    // they are from the middle of the partition -- which is what lets a flat partition follow
+    // the slope of the decay across it. they're empty everywhere else.
+    std::vector<std::vector<float>> ramp;
+
+    // whether the spectra above have been worked out yet. a stage that was left for
+    // loadDeferredStages() still runs its delay line, so once it's ready it has the input it
+    // needs straight away, but it stays silent until then.
+    std::atomic<bool> ready { false };
+
+    size_t getSizeInBytes() const
+    {
+        size_t total = 0;
+        for (auto* spectra : { &impulseResponse, &ramp })
+            for (auto& s : *spectra)
+                total += s.size() * sizeof(float);
+
+        return total;
+    }
+};
+
+// one uniformly partitioned stage, with numBins = blockSize + 1 frequency bins per partition.
+struct PartitionedConvolver::Stage
+{
+    int blockSize = 0;
+    int offset = 0;             // where this stage's part of the IR starts.
+    int numPartitions = 0;
+    int numBins = 0;
+    int segment = 0;            // which output ring it writes into.
+
+    std::unique_ptr<juce::dsp::FFT> fft;
+
+    // the partition spectra, either worked out for us or shared with an earlier load.
+    std::shared_ptr<Spectra::StageSpectra> spectra;
+
+    // whether the stage is in the decaying tail, in which case partitionMoments has the energy
+    // sums the normalisation needs (plain, ramp-weighted and ramp-squared), three per partition,
+    // per IR channel.
+    bool decays = false;
+    std::vector<std::vector<double>> partitionMoments;
+
+    // which partitions are loud enough to run (see quietPartitionLevel), and how many of them
+    // come before each one -- so the count for the first n is activeCounts[n].
+    std::vector<bool> activePartitions;
+    std::vector<int> activeCounts;
+
+    // the frequency-domain delay line: the spectra of the last numPartitions input blocks, per
+    // processing channel. newestInput is the slot holding the most recent one.
+    std::vector<std::vector<float>> inputSpectra;
+    int newestInput = 0;
+
+    // scratch space. JUCE's real-only transforms need twice the FFT size. the accumulator holds
+    // one summed spectrum per processing channel.
+    std::vector<float> fftBuffer;
+    std::vector<float> accumulator;
+
+    // stereo only: the packed complex frames in and out of the shared transform.
+    std::vector<juce::dsp::Complex<float>> packedInput, packedOutput;
+
+    // the output of the latest run, waiting to be added into the ring.
+    juce::AudioBuffer<float> output;
+
+    // stages with enough slack get sent to the worker pool. pendingTime is the time of the run
+    // that's out there now, or -1 if there isn't one.
+    bool runsOnWorker = false;
+    std::unique_ptr<StageTask> task;
+    juce::int64 pendingTime = -1;
+
+    size_t getSpectrumSize() const { return (size_t) numBins * 2; }
+};
+
+namespace
+{
+    // the same resampling juce::dsp::Convolution does when an IR's rate doesn't match.
+    juce::AudioBuffer<float> resampleImpulseResponse(const juce::AudioBuffer<float>& buffer, double sourceRate, double targetRate)
+    {
+        const auto ratio = sourceRate / targetRate;
+        const auto finalSize = juce::roundToInt(juce::jmax(1.0, buffer.getNumSamples() / ratio));
+
+        // MemoryAudioSource wants a non-const buffer, but with copyMemory off it only reads it.
+        juce::MemoryAudioSource source(const_cast<juce::AudioBuffer<float>&>(buffer), false);
+        juce::ResamplingAudioSource resampler(&source, false, buffer.getNumChannels());
+        resampler.setResamplingRatio(ratio);
+        resampler.prepareToPlay(finalSize, sourceRate);
+
+        juce::AudioBuffer<float> result(buffer.getNumChannels(), finalSize);
+        resampler.getNextAudioBlock(juce::AudioSourceChannelInfo(&result, 0, finalSize));
+        return result;
+    }
+
+    // the envelope the IR synthesis uses is exp(-6.91 * t / decayTime), so this takes it down
+    // 60dB over one decay time.
+    constexpr double decayConstant = 6.91;
+
+    // how quickly we follow a change in decay time or segment gain, in seconds.
+    constexpr double decaySmoothingTime = 0.02;
+    constexpr double gainSmoothingTime = 0.02;
+
+    // how long the IR and the feedback network crossfade for, and how dark the network's lowpass
+    // is allowed to get.
+    constexpr double feedbackCrossfadeSeconds = 0.2;
+    constexpr double maximumToneCoefficient = 0.95;
+
+    // a partition's slope is ignored once it's this small -- it's not worth a second pass.
+    constexpr float minimumRamp = 0.01f;
+
+    // how finely we keep track of the IR's energy over time, for levelling a high band's.
+    constexpr double energyProfileSeconds = 0.01;
+
+    double getEnergy(const float* data, int numSamples)
+    {
+        double energy = 0.0;
+        for (int i = 0; i < numSamples; ++i)
+            energy += (double) data[i] * data[i];
+
+        return energy;
+    }
+
+    bool isSilent(const juce::AudioBuffer<float>& buffer, int start, int end)
+    {
+        for (int c = 0; c < buffer.getNumChannels(); ++c)
+        {
+            const auto* data = buffer.getReadPointer(c);
+            if (std::any_of(data + start, data + end, [](float sample) { return sample != 0.0f; }))
+                return false;
+        }
+
+        return true;
+    }
+}
+
+PartitionedConvolver::PartitionedConvolver()
+    : PartitionedConvolver(Scheme())
+{
+}
+
+PartitionedConvolver::PartitionedConvolver(const Scheme& s)
+    : scheme(s),
+      multiplyAccumulate(SpectralKernels::getMultiplyAccumulate())
+{
+    jassert(juce::isPowerOfTwo(scheme.headBlockSize) && juce::isPowerOfTwo(scheme.growthFactor) && scheme.growthFactor > 1);
+    jassert(juce::isPowerOfTwo(scheme.maximumBlockSize) && scheme.maximumBlockSize >= scheme.headBlockSize);
+    jassert(scheme.decimation >= 1);
+
+    // any fewer and the tail stages can't get their output in on time.
+    jassert(scheme.partitionsPerStage >= scheme.growthFactor - 1);
+
+    // the high band runs at the full rate, with the biggest head partitions that still leave its
+    // latency no more than ours. the difference goes on the front of its IR.
+    if (scheme.splitBands && scheme.decimation > 1)
+    {
+        auto highBandScheme = scheme;
+        highBandScheme.decimation = 1;
+        highBandScheme.splitBands = false;
+        highBandScheme.headBlockSize = juce::jmin(scheme.maximumBlockSize, juce::nextPowerOfTwo(scheme.headBlockSize * scheme.decimation + 1) / 2);
+
+        highBand = std::make_unique<PartitionedConvolver>(highBandScheme);
+    }
+}
+
+PartitionedConvolver::~PartitionedConvolver()
+{
+    finishDeferredLoading();
+    cancelPendingWork();
+}
+
+bool PartitionedConvolver::Spectra::isComplete() const
+{
+    for (auto& stage : stages)
+        if (! stage->ready.load(std::memory_order_acquire))
+            return false;
+
+    return highBand == nullptr || highBand->isComplete();
+}
+
+size_t PartitionedConvolver::Spectra::getSizeInBytes() const
+{
+    size_t total = highBand != nullptr ? highBand->getSizeInBytes() : 0;
+    for (auto& stage : stages)
+        total += stage->getSizeInBytes();
+
+    return total;
+}
+
+void PartitionedConvolver::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    sampleRate = spec.sampleRate / scheme.decimation;
+    numChannels = (int) spec.numChannels;
+
+    if (scheme.decimation > 1)
+    {
+        decimator.prepare(scheme.decimation, numChannels);
+        interpolator.prepare(scheme.decimation, numChannels, (int) spec.maximumBlockSize);
+        decimatedBuffer.setSize(numChannels, (int) spec.maximumBlockSize / scheme.decimation + 1);
+    }
+
+    hostChannels.resize((size_t) numChannels);
+
+    if (highBand != nullptr)
+    {
+        highBand->prepare(spec);
+        highBandBuffer.setSize(numChannels, (int) spec.maximumBlockSize);
+    }
+
+    reflectionDelay.clear();
+    reflectionBuffer.setSize(numChannels, (int) spec.maximumBlockSize);
+    reflectionGains.resize(spec.maximumBlockSize);
+    reflectionGain.reset(spec.sampleRate, gainSmoothingTime);
+
+    finishDeferredLoading();
+    cancelPendingWork();
+    stages.clear();
+    spectra = std::make_shared<Spectra>();
+    firLength = 0;
+    impulseResponseLength = 0;
+    numImpulseResponseChannels = 0;
+    trueStereo = false;
+    decayStartSample = -1;
+    lateStartSample = -1;
+    inputHistory.setSize(0, 0);
+    samplesProcessed = 0;
+
+    for (auto& segment : segments)
+    {
+        segment.ring.setSize(0, 0);
+        segment.fixedEnergies.clear();
+        segment.decayingEnergies.clear();
+        segment.gain.reset(sampleRate, gainSmoothingTime);
+    }
+
+    segmentGainBuffer.setSize(numSegments, scheme.headBlockSize);
+}
+
+void PartitionedConvolver::loadImpulseResponse(const juce::AudioBuffer<float>& impulseResponse, double impulseResponseSampleRate,
+                                               bool normalise, const Layout& layout, const std::shared_ptr<const Spectra>& cachedSpectra)
+{
+    jassert(numChannels > 0);
+
+    // only make a new buffer if we actually have to resample.
+    juce::AudioBuffer<float> resampled;
+    const bool needsResampling = impulseResponseSampleRate > 0.0 && impulseResponseSampleRate != sampleRate;
+    if (needsResampling)
+        resampled = resampleImpulseResponse(impulseResponse, impulseResponseSampleRate, sampleRate);
+
+    const auto& source = needsResampling ? resampled : impulseResponse;
+
+    finishDeferredLoading();
+    cancelPendingWork();
+    stages.clear();
+    spectra = std::make_shared<Spectra>();
+    firLength = 0;
+    firIsSilent = false;
+    reflectionDelay.clear();
+    numImpulseResponseChannels = source.getNumChannels();
+    trueStereo = numChannels == 2 && numImpulseResponseChannels == 4;
+
+    juce::AudioBuffer<float> blended;
+    const auto& ir = prepareFeedbackTail(source, layout, blended);
+    impulseResponseLength = ir.getNumSamples();
+
+    if (layout.end >= 0.0)
+        impulseResponseLength = juce::jmin(impulseResponseLength, (int) std::ceil(layout.end * sampleRate));
+
+    normalising = normalise;
+    energyProfile.clear();
+
+    for (auto& segment : segments)
+    {
+        segment.fixedEnergies.assign((size_t) numImpulseResponseChannels, 0.0);
+        segment.decayingEnergies.assign((size_t) numImpulseResponseChannels, 0.0);
+    }
+
+    if (impulseResponseLength == 0 || numImpulseResponseChannels == 0)
+        return;
+
+    energyProfileLength = juce::jmax(1, (int) (energyProfileSeconds * sampleRate));
+    energyProfile.assign((size_t) ((impulseResponseLength + energyProfileLength - 1) / energyProfileLength), 0.0);
+
+    for (int c = 0; c < numImpulseResponseChannels; ++c)
+        for (int start = 0; start < impulseResponseLength; start += energyProfileLength)
+            energyProfile[(size_t) (start / energyProfileLength)] += getEnergy(ir.getReadPointer(c) + start,
+                                                                               juce::jmin(energyProfileLength, impulseResponseLength - start))
+                                                                   / numImpulseResponseChannels;
+
+    // in zero-latency mode, the first head block of the IR becomes the FIR.
+    if (scheme.zeroLatency)
+    {
+        firLength = juce::jmin(scheme.headBlockSize, impulseResponseLength);
+        firTaps.setSize(numImpulseResponseChannels, firLength);
+        for (int c = 0; c < numImpulseResponseChannels; ++c)
+            juce::FloatVectorOperations::copy(firTaps.getWritePointer(c), ir.getReadPointer(c), firLength);
+
+        firInput.setSize(numChannels, firLength - 1 + scheme.headBlockSize);
+        firIsSilent = isSilent(ir, 0, firLength);
+    }
+
+    // both boundaries go on a head block boundary, and never inside the FIR. the late start gets
+    // rounded whichever way makes the late part bigger, so none of it ends up in the early part.
+    const auto headBlockSize = scheme.headBlockSize;
+    auto toSample = [&](double seconds, bool roundUp)
+    {
+        if (seconds < 0.0)
+            return -1;
+
+        const auto blocks = seconds * sampleRate / headBlockSize;
+        return juce::jmax(firLength, (int) (roundUp ? std::ceil(blocks) : std::floor(blocks)) * headBlockSize);
+    };
+
+    decayStartSample = toSample(layout.decayStart, false);
+    lateStartSample = toSample(layout.lateStart, layout.lateFirst);
+    lateFirst = layout.lateFirst;
+    feedbackSegment = lateStartSample >= 0 && feedbackStartSample >= lateStartSample ? 1 : 0;
+
+    const int deferredStartSample = layout.deferredStart >= 0.0 ? (int) (layout.deferredStart * sampleRate) : -1;
+
+    // everything that isn't decayed by us goes into the normalisation as it is. the decaying
+    // part's share depends on the decay time, so that gets worked out whenever it changes.
+    for (int c = 0; c < numImpulseResponseChannels; ++c)
+    {
+        const auto* data = ir.getReadPointer(c);
+        const int fixedEnd = decayStartSample >= 0 ? juce::jmin(decayStartSample, impulseResponseLength) : impulseResponseLength;
+        const int split = lateStartSample >= 0 ? juce::jmin(lateStartSample, fixedEnd) : fixedEnd;
+
+        segments[0].fixedEnergies[(size_t) c] = getEnergy(data, split);
+        segments[1].fixedEnergies[(size_t) c] = getEnergy(data + split, fixedEnd - split);
+    }
+
+    // the reflections are impulses, so each one's energy is just its gain squared. they run at
+    // the host rate, and come out with our latency, the same as everything else.
+    if (layout.reflections.getNumTaps() > 0)
+    {
+        jassert(layout.reflections.gains.getNumChannels() == numImpulseResponseChannels);
+
+        for (int c = 0; c < numImpulseResponseChannels; ++c)
+        {
+            const auto* gains = layout.reflections.gains.getReadPointer(c);
+            segments[0].fixedEnergies[(size_t) c] += getEnergy(gains, layout.reflections.getNumTaps());
+        }
+
+        reflectionDelay.setTaps(layout.reflections, sampleRate * scheme.decimation, scheme.getLatency(),
+                                numChannels, reflectionBuffer.getNumSamples());
+    }
+
+    // with everything we don't decay counted, we know how quiet a partition of it can be and
+    // still be worth running.
+    quietPartitionLevel = findQuietPartitionLevel(ir, decayStartSample >= 0 ? juce::jmin(decayStartSample, impulseResponseLength)
+                                                                             : impulseResponseLength);
+
+    // carve the rest of the IR up: partitionsPerStage partitions at each size, growing until we
+    // hit the biggest size, which then takes everything that's left. a stage can't straddle the
+    // decay start or the late start, so if we'd hit one part-way through a partition, the gap
+    // gets filled with smaller ones instead.
+    auto getNextBoundary = [this](int offset)
+    {
+        int boundary = std::numeric_limits<int>::max();
+        for (auto b : { decayStartSample, lateStartSample })
+            if (b > offset)
+                boundary = juce::jmin(boundary, b);
+
+        return boundary;
+    };
+
+    int offset = firLength;
+    int blockSize = headBlockSize;
+
+    while (offset < impulseResponseLength)
+    {
+        const int remaining = impulseResponseLength - offset;
+        const bool isLastSize = blockSize >= scheme.maximumBlockSize;
+        const int partitionsLeft = (remaining + blockSize - 1) / blockSize;
+
+        int stageBlockSize = blockSize;
+        int numPartitions = isLastSize ? partitionsLeft : juce::jmin(scheme.partitionsPerStage, partitionsLeft);
+
+        if (const int untilBoundary = getNextBoundary(offset) - offset; untilBoundary < numPartitions * blockSize)
+        {
+            if (untilBoundary < blockSize)
+            {
+                stageBlockSize = juce::nextPowerOfTwo(untilBoundary + 1) / 2;
+                numPartitions = 1;
+            }
+            else
+            {
+                numPartitions = untilBoundary / blockSize;
+            }
+        }
+
+        // a stretch that's silent all the way through doesn't need a stage at all. the sizes
+        // carry on as if it had one, so every stage after it still makes its deadline.
+        // the same goes for one whose partitions are all too quiet to run.
+        const int stageEnd = juce::jmin(impulseResponseLength, offset + numPartitions * stageBlockSize);
+        // the same IR and layout always give the same stages, so given spectra line up with ours
+        // one for one.
+        if (! isSilent(ir, offset, stageEnd))
+        {
+            const auto index = stages.size();
+            auto cached = cachedSpectra != nullptr && index < cachedSpectra->stages.size() ? cachedSpectra->stages[index] : nullptr;
+            auto stage = createStage(ir, offset, stageBlockSize, numPartitions, deferredStartSample < 0 || offset < deferredStartSample,
+                                     cached);
+
+            if (stage->activeCounts.back() > 0)
+            {
+                spectra->stages.push_back(stage->spectra);
+                stages.push_back(std::move(stage));
+            }
+        }
+
+        offset += numPartitions * stageBlockSize;
+
+        // only move up a size after a full stage at this one, or the next stage couldn't make
+        // its deadline.
+        if (! isLastSize && stageBlockSize == blockSize && numPartitions == scheme.partitionsPerStage)
+            blockSize = juce::jmin(blockSize * scheme.growthFactor, scheme.maximumBlockSize);
+    }
+
+    // every stage reads the last 2B input samples, and writes up to its offset past the current
+    // time -- the rings just have to be big enough for the largest of each. a stage that's out on
+    // a worker keeps reading its input for up to another block, hence the extra room in the
+    // history. each output ring only has to cover its own segment's stages.
+    int largestBlock = 0;
+    int largestSegmentBlock[numSegments] = {}, furthestOffset[numSegments] = {};
+    for (auto& stage : stages)
+    {
+        largestBlock = juce::jmax(largestBlock, stage->blockSize);
+        largestSegmentBlock[stage->segment] = juce::jmax(largestSegmentBlock[stage->segment], stage->blockSize);
+        furthestOffset[stage->segment] = juce::jmax(furthestOffset[stage->segment], stage->offset);
+    }
+
+    // the network writes its output into the ring as if it were a stage at the feedback start.
+    if (feedbackStartSample >= 0)
+    {
+        largestSegmentBlock[feedbackSegment] = juce::jmax(largestSegmentBlock[feedbackSegment], headBlockSize);
+        furthestOffset[feedbackSegment] = juce::jmax(furthestOffset[feedbackSegment], feedbackStartSample);
+    }
+
+    const int historySize = juce::nextPowerOfTwo(juce::jmax(largestBlock * 3, headBlockSize));
+    inputHistory.setSize(numChannels, historySize);
+    historyMask = historySize - 1;
+
+    for (int s = 0; s < numSegments; ++s)
+    {
+        const int outputSize = juce::nextPowerOfTwo(furthestOffset[s] + largestSegmentBlock[s] + headBlockSize);
+        segments[(size_t) s].ring.setSize(numChannels, outputSize);
+        segments[(size_t) s].mask = outputSize - 1;
+    }
+
+    // the stages we've left for later need their part of the IR kept until then. it's copied,
+    // as whoever loaded us might not hold on to theirs.
+    auto firstDeferred = std::find_if(stages.begin(), stages.end(), [](auto& stage) { return ! stage->spectra->ready.load(); });
+    if (firstDeferred != stages.end())
+    {
+        deferredStart = (*firstDeferred)->offset;
+        deferredImpulseResponse.setSize(numImpulseResponseChannels, impulseResponseLength - deferredStart);
+
+        for (int c = 0; c < numImpulseResponseChannels; ++c)
+            deferredImpulseResponse.copyFrom(c, 0, ir, c, deferredStart, impulseResponseLength - deferredStart);
+
+        deferredLoadState.store(DeferredLoadState::waiting);
+    }
+
+    // until the first block works out the decay, every partition we kept counts.
+    int numActive = 0;
+    for (auto& stage : stages)
+        numActive += stage->activeCounts.back();
+
+    numActivePartitions.store(numActive);
+
+    reset();
+}
+
+double PartitionedConvolver::findQuietPartitionLevel(const juce::AudioBuffer<float>& ir, int fixedEnd) const
+{
+    // every energy profile block's level, at its loudest over the channels, with as much energy
+    // as it could be taking out of any one of them. the quietest go first, for as long as they
+    // still fit in the budget, and the last one that does sets the level. with no budget at all,
+    // only the partitions that are silent through and through get skipped.
+    std::vector<std::pair<double, double>> blocks;
+    for (int start = 0; start < fixedEnd; start += energyProfileLength)
+    {
+        const int length = juce::jmin(energyProfileLength, fixedEnd - start);
+        double loudest = 0.0;
+
+        for (int c = 0; c < numImpulseResponseChannels; ++c)
+            loudest = juce::jmax(loudest, getEnergy(ir.getReadPointer(c) + start, length) / length);
+
+        blocks.emplace_back(loudest, loudest * length);
+    }
+
+    std::sort(blocks.begin(), blocks.end());
+
+    double totalEnergy = 0.0;
+    for (int c = 0; c < numImpulseResponseChannels; ++c)
+        totalEnergy = juce::jmax(totalEnergy, segments[0].fixedEnergies[(size_t) c] + segments[1].fixedEnergies[(size_t) c]);
+
+    // it's energy we're budgeting, so the decibels are tenths of a decade rather than twentieths.
+    auto budget = totalEnergy * std::pow(10.0, scheme.partitionSkipDecibels / 10.0);
+
+    double quietLevel = 0.0;
+    for (const auto& [level, energy] : blocks)
+    {
+        if (energy > budget)
+            break;
+
+        budget -= energy;
+        quietLevel = level;
+    }
+
+    return quietLevel;
+}
+
+const juce::AudioBuffer<float>& PartitionedConvolver::prepareFeedbackTail(const juce::AudioBuffer<float>& ir, const Layout& layout,
+                                                                         juce::AudioBuffer<float>& blended)
+{
+    feedbackStartSample = -1;
+    feedbackPowers.clear();
+    feedbackWeights.clear();
+
+    if (layout.feedbackStart < 0.0 || layout.decayStart < 0.0 || numChannels == 0)
+        return ir;
+
+    // a reversed IR's tail comes first, so there's nothing here for the network to take over.
+    jassert(! layout.lateFirst);
+
+    const int length = layout.end >= 0.0 ? juce::jmin(ir.getNumSamples(), (int) std::ceil(layout.end * sampleRate)) : ir.getNumSamples();
+    const int decayStart = juce::roundToInt(layout.decayStart * sampleRate);
+    const int start = juce::jmax(decayStart, juce::roundToInt(layout.feedbackStart * sampleRate));
+    const int crossfadeLength = juce::roundToInt(feedbackCrossfadeSeconds * sampleRate);
+    const int end = start + crossfadeLength;
+
+    // every path's crossfade gets the network's response on that path taken out of it, so each
+    // IR channel can only be feeding the one output.
+    const bool channelPerPath = trueStereo || numImpulseResponseChannels >= numChannels;
+    if (end > length || ! channelPerPath || crossfadeLength == 0)
+        return ir;
+
+    // the tail's power, and how alike neighbouring samples are, taken over everything from the
+    // decay start to the end of the crossfade. the latter is the coefficient of the one-pole
+    // lowpass that gives white noise the same correlation, averaged over the channels.
+    feedbackPowers.assign((size_t) numImpulseResponseChannels, 0.0);
+    double correlation = 0.0;
+
+    for (int c = 0; c < numImpulseResponseChannels; ++c)
+    {
+        const auto* data = ir.getReadPointer(c);
+        const auto energy = getEnergy(data + decayStart, end - decayStart);
+
+        double lagged = 0.0;
+        for (int i = decayStart + 1; i < end; ++i)
+            lagged += (double) data[i] * data[i - 1];
+
+        feedbackPowers[(size_t) c] = energy / (end - decayStart);
+        correlation += energy > 0.0 ? lagged / energy / numImpulseResponseChannels : 0.0;
+    }
+
+    feedbackNetwork.prepare(sampleRate, numChannels, numChannels);
+    feedbackNetwork.setToneCoefficient((float) juce::jlimit(0.0, maximumToneCoefficient, correlation));
+
+    for (int input = 0; input < numChannels; ++input)
+        for (int output = 0; output < numChannels; ++output)
+            if (const int c = getImpulseResponseChannel(input, output); c >= 0)
+            {
+                const auto power = feedbackNetwork.getImpulseResponsePower(input, output);
+                feedbackNetwork.setInputGain(input, output, power > 0.0 ? (float) std::sqrt(feedbackPowers[(size_t) c] / power) : 0.0f);
+            }
+
+    // the IR up to the end of the crossfade, with it baked in. the network's response is all
+    // there from the start, so over the crossfade its difference from the fade-in comes off the
+    // IR, and the two sum to the IR fading out and the network fading in.
+    blended.setSize(numImpulseResponseChannels, end);
+    for (int c = 0; c < numImpulseResponseChannels; ++c)
+        blended.copyFrom(c, 0, ir, c, 0, end);
+
+    for (int input = 0; input < numChannels; ++input)
+        for (int output = 0; output < numChannels; ++output)
+            if (const int c = getImpulseResponseChannel(input, output); c >= 0)
+            {
+                const auto response = feedbackNetwork.renderImpulseResponse(input, output, crossfadeLength);
+                auto* data = blended.getWritePointer(c) + start;
+
+                for (int i = 0; i < crossfadeLength; ++i)
+                {
+                    const auto phase = juce::MathConstants<double>::halfPi * (i + 0.5) / crossfadeLength;
+                    data[i] = (float) (data[i] * std::cos(phase) + response[(size_t) i] * (std::sin(phase) - 1.0));
+                }
+            }
+
+    // the two are uncorrelated, so over the crossfade the energy is the IR's cos^2 and the
+    // network's sin^2 -- what the partitions count is the IR's cos^2 plus (sin - 1)^2 of the
+    // network's, and this is the rest.
+    feedbackWeights.resize((size_t) crossfadeLength);
+    for (int i = 0; i < crossfadeLength; ++i)
+        feedbackWeights[(size_t) i] = 2.0 * std::sin(juce::MathConstants<double>::halfPi * (i + 0.5) / crossfadeLength) - 1.0;
+
+    feedbackInputs.resize((size_t) numChannels);
+    feedbackBuffer.setSize(numChannels, scheme.headBlockSize);
+    feedbackStartSample = start;
+
+    return blended;
+}
+
+void PartitionedConvolver::loadHighBandImpulseResponse(const juce::AudioBuffer<float>& impulseResponse, double impulseResponseSampleRate,
+                                                       const Layout& layout, const std::shared_ptr<const Spectra>& cachedSpectra)
+{
+    jassert(highBand != nullptr && numChannels > 0);
+
+    const double hostRate = sampleRate * scheme.decimation;
+    juce::AudioBuffer<float> resampled;
+    const bool needsResampling = impulseResponseSampleRate > 0.0 && impulseResponseSampleRate != hostRate;
+    if (needsResampling)
+        resampled = resampleImpulseResponse(impulseResponse, impulseResponseSampleRate, hostRate);
+
+    const auto& ir = needsResampling ? resampled : impulseResponse;
+
+    int length = ir.getNumSamples();
+    if (layout.end >= 0.0)
+        length = juce::jmin(length, (int) std::ceil(layout.end * hostRate));
+
+    // the complement of what the resampling filters let through: the IR delayed by as much as
+    // they delay it, minus the IR through the pair of them. in front of that goes whatever it
+    // takes to make the high band's latency up to ours.
+    const auto crossover = PolyphaseResampling::getRoundTripResponse(scheme.decimation);
+    const int filterDelay = PolyphaseResampling::getLatency(scheme.decimation);
+    const int alignment = scheme.getPartitionLatency() * scheme.decimation - highBand->scheme.getPartitionLatency();
+    const int delay = alignment + filterDelay;
+
+    juce::AudioBuffer<float> highPassed(ir.getNumChannels(), length > 0 ? alignment + length + (int) crossover.size() - 1 : 0);
+    highPassed.clear();
+
+    // both IRs are taken to be the same room at different rates, so they're levelled by their
+    // energy over the same stretch of time -- that's what gives them the same response where
+    // they meet. the high band then rides on our normalisation, so the two can decay differently
+    // without the highs getting turned up to make up for it.
+    const int profileBlockLength = energyProfileLength * scheme.decimation;
+    const auto numProfileBlocks = juce::jmin(energyProfile.size(),
+                                             (size_t) juce::jmax(1, juce::jmin(length, impulseResponseLength * scheme.decimation) / profileBlockLength));
+    const int levellingLength = juce::jmin(length, (int) numProfileBlocks * profileBlockLength);
+    const double energy = std::accumulate(energyProfile.begin(), energyProfile.begin() + (std::ptrdiff_t) numProfileBlocks, 0.0);
+
+    double highBandEnergy = 0.0;
+    for (int c = 0; c < ir.getNumChannels() && length > 0; ++c)
+    {
+        const auto* source = ir.getReadPointer(c);
+        auto* destination = highPassed.getWritePointer(c) + alignment;
+
+        juce::FloatVectorOperations::add(destination + filterDelay, source, length);
+
+        for (size_t k = 0; k < crossover.size(); ++k)
+            juce::FloatVectorOperations::addWithMultiply(destination + k, source, -crossover[k], length);
+
+        highBandEnergy += getEnergy(source, levellingLength) / ir.getNumChannels();
+    }
+
+    highBandGain = highBandEnergy > 0.0 ? (float) std::sqrt(energy / highBandEnergy) : 0.0f;
+
+    // everything in the layout moves along with the IR.
+    auto shift = [&](double seconds) { return seconds >= 0.0 ? seconds + delay / hostRate : seconds; };
+
+    Layout highBandLayout;
+    highBandLayout.decayStart = shift(layout.decayStart);
+    highBandLayout.lateStart = shift(layout.lateStart);
+    highBandLayout.lateFirst = layout.lateFirst;
+    highBandLayout.deferredStart = shift(layout.deferredStart);
+
+    highBand->loadImpulseResponse(highPassed, hostRate, false, highBandLayout,
+                                  cachedSpectra != nullptr ? cachedSpectra->highBand : nullptr);
+    highBand->decayOrigin = delay;
+    spectra->highBand = highBand->spectra;
+}
+
+bool PartitionedConvolver::claimDeferredStages()
+{
+    // the high band's stages are loaded under our claim, so that our destructor waits for them
+    // as well.
+    highBandClaimed = highBand != nullptr && highBand->claimDeferredStages();
+
+    auto expected = DeferredLoadState::waiting;
+    if (deferredLoadState.compare_exchange_strong(expected, DeferredLoadState::loading))
+        return true;
+
+    expected = DeferredLoadState::none;
+    return highBandClaimed && deferredLoadState.compare_exchange_strong(expected, DeferredLoadState::loading);
+}
+
+void PartitionedConvolver::loadDeferredStages(const std::function<bool()>& shouldStop)
+{
+    jassert(deferredLoadState.load() == DeferredLoadState::loading);
+
+    // in order, so the nearest (and smallest) stages come in first. if we're told to stop --
+    // or we're being destroyed or reloaded -- whatever's left just stays silent.
+    auto stop = [this, &shouldStop] { return abandonDeferredLoading.load() || (shouldStop != nullptr && shouldStop()); };
+
+    bool finished = true;
+    for (auto& stage : stages)
+    {
+        if (stage->spectra->ready.load(std::memory_order_relaxed))
+            continue;
+
+        if (! transformStage(*stage, deferredImpulseResponse, deferredStart, stop))
+        {
+            finished = false;
+            break;
+        }
+    }
+
+    if (finished)
+        deferredImpulseResponse.setSize(0, 0);
+
+    if (highBandClaimed)
+    {
+        highBandClaimed = false;
+        highBand->loadDeferredStages(stop);
+    }
+
+    // this has to be the last thing we touch -- finishDeferredLoading() could be waiting on it
+    // to free everything.
+    deferredLoadState.store(finished ? DeferredLoadState::none : DeferredLoadState::waiting);
+}
+
+void PartitionedConvolver::finishDeferredLoading()
+{
+    abandonDeferredLoading.store(true);
+
+    for (;;)
+    {
+        auto state = deferredLoadState.load();
+
+        if (state == DeferredLoadState::loading)
+            juce::Thread::sleep(1);
+        else if (state == DeferredLoadState::none || deferredLoadState.compare_exchange_strong(state, DeferredLoadState::none))
+            break;
+    }
+
+    deferredImpulseResponse.setSize(0, 0);
+    abandonDeferredLoading.store(false);
+}
+
+std::unique_ptr<PartitionedConvolver::Stage> PartitionedConvolver::createStage(const juce::AudioBuffer<float>& ir, int offset,
+                                                                               int blockSize, int numPartitions, bool transformNow,
+                                                                               const std::shared_ptr<Spectra::StageSpectra>& cached)
+{
+    auto stage = std::make_unique<Stage>();
+    stage->blockSize = blockSize;
+    stage->offset = offset;
+    stage->numPartitions = numPartitions;
+    stage->numBins = blockSize + 1;
+    stage->fft = std::make_unique<juce::dsp::FFT>(juce::roundToInt(std::log2(blockSize * 2)));
+    stage->fftBuffer.resize((size_t) blockSize * 4);
+    stage->accumulator.resize((size_t) numChannels * stage->getSpectrumSize());
+    stage->decays = decayStartSample >= 0 && offset >= decayStartSample;
+    stage->segment = lateStartSample >= 0 && offset >= lateStartSample ? 1 : 0;
+
+    if (numChannels == 2)
+    {
+        stage->packedInput.resize((size_t) blockSize * 2);
+        stage->packedOutput.resize((size_t) blockSize * 2);
+    }
+
+    // spectra from an earlier load can only stand in for ours if they're finished, and for exactly
+    // the same stretch of the IR, cut up the same way.
+    const bool reuseSpectra = cached != nullptr && cached->ready.load(std::memory_order_acquire)
+                           && cached->offset == offset && cached->blockSize == blockSize && cached->numPartitions == numPartitions
+                           && (int) cached->impulseResponse.size() == numImpulseResponseChannels
+                           && (int) cached->ramp.size() == numImpulseResponseChannels
+                           && (numImpulseResponseChannels == 0 || cached->ramp.front().empty() != stage->decays);
+
+    if (reuseSpectra)
+    {
+        stage->spectra = cached;
+    }
+    else
+    {
+        stage->spectra = std::make_shared<Spectra::StageSpectra>();
+        stage->spectra->offset = offset;
+        stage->spectra->blockSize = blockSize;
+        stage->spectra->numPartitions = numPartitions;
+    }
+
+    // new spectra get their room now, even when they're being left for later, so nothing has to
+    // be allocated once we're running. the moments are cheap, so they're always worked out here
+    // -- the normalisation needs every partition from the start.
+    const auto spectraSize = (size_t) numPartitions * stage->getSpectrumSize();
+    const double centre = 0.5 * (blockSize - 1);
+
+    for (int c = 0; c < numImpulseResponseChannels; ++c)
+    {
+        std::vector<double> moments(stage->decays ? (size_t) numPartitions * 3 : 0);
+        const auto* source = ir.getReadPointer(c);
+
+        for (int p = 0; p < numPartitions && stage->decays; ++p)
+        {
+            const int start = offset + p * blockSize;
+            const int length = juce::jmax(0, juce::jmin(blockSize, impulseResponseLength - start));
+            double plain = 0.0, ramped = 0.0, rampedSquared = 0.0;
+
+            for (int i = 0; i < length; ++i)
+            {
+                const double u = (i - centre) / blockSize;
+                const double energy = (double) source[start + i] * source[start + i];
+
+                plain += energy;
+                ramped += energy * u;
+                rampedSquared += energy * u * u;
+            }
+
+            moments[(size_t) p * 3]     = plain;
+            moments[(size_t) p * 3 + 1] = ramped;
+            moments[(size_t) p * 3 + 2] = rampedSquared;
+        }
+
+        if (! reuseSpectra)
+        {
+            stage->spectra->impulseResponse.emplace_back(spectraSize);
+            stage->spectra->ramp.emplace_back(stage->decays ? spectraSize : 0);
+        }
+
+        stage->partitionMoments.push_back(std::move(moments));
+    }
+
+    // the decay takes care of its own partitions, so it's only the rest that can be too quiet.
+    stage->activePartitions.assign((size_t) numPartitions, true);
+    stage->activeCounts.assign(1, 0);
+
+    for (int p = 0; p < numPartitions; ++p)
+    {
+        const int start = offset + p * blockSize;
+        const int length = juce::jmax(0, juce::jmin(blockSize, impulseResponseLength - start));
+
+        if (! stage->decays)
+        {
+            double loudest = 0.0;
+            for (int c = 0; c < numImpulseResponseChannels && length > 0; ++c)
+                loudest = juce::jmax(loudest, getEnergy(ir.getReadPointer(c) + start, length) / length);
+
+            stage->activePartitions[(size_t) p] = loudest > quietPartitionLevel;
+        }
+
+        stage->activeCounts.push_back(stage->activeCounts.back() + (stage->activePartitions[(size_t) p] ? 1 : 0));
+    }
+
+    if (transformNow && ! reuseSpectra)
+        transformStage(*stage, ir, 0);
+
+    stage->inputSpectra.assign((size_t) numChannels, std::vector<float>(spectraSize, 0.0f));
+    stage->output.setSize(numChannels, blockSize);
+    stage->runsOnWorker = scheme.useWorkerThreads && offset + scheme.getPartitionLatency() >= 2 * blockSize;
+    stage->task = std::make_unique<StageTask>(*this, *stage);
+
+    return stage;
+}
+
+bool PartitionedConvolver::transformStage(Stage& stage, const juce::AudioBuffer<float>& ir, int irStart,
+                                          const std::function<bool()>& shouldStop)
+{
+    const auto blockSize = stage.blockSize;
+    const auto spectrumSize = stage.getSpectrumSize();
+
+    // this can be running while the stage is, so it needs scratch space of its own.
+    std::vector<float> fftBuffer(stage.fftBuffer.size());
+    auto* fftData = fftBuffer.data();
+
+    // each partition goes in the first half of the FFT frame, with zeros after it.
+    auto transformInto = [&](std::vector<float>& spectra, int partition)
+    {
+        stage.fft->performRealOnlyForwardTransform(fftData, true);
+        std::copy(fftData, fftData + spectrumSize, spectra.begin() + (std::ptrdiff_t) ((size_t) partition * spectrumSize));
+    };
+
+    const double centre = 0.5 * (blockSize - 1);
+
+    for (int c = 0; c < numImpulseResponseChannels; ++c)
+    {
+        const auto* source = ir.getReadPointer(c);
+
+        for (int p = 0; p < stage.numPartitions; ++p)
+        {
+            if (shouldStop != nullptr && shouldStop())
+                return false;
+
+            // a skipped partition's spectrum is never read, so it's left at zero.
+            if (! stage.activePartitions[(size_t) p])
+                continue;
+
+            const int start = stage.offset + p * blockSize;
+            const int length = juce::jmax(0, juce::jmin(blockSize, impulseResponseLength - start));
+            const auto* samples = source + start - irStart;
+
+            std::fill(fftBuffer.begin(), fftBuffer.end(), 0.0f);
+            std::copy(samples, samples + length, fftData);
+            transformInto(stage.spectra->impulseResponse[(size_t) c], p);
+
+            if (! stage.decays)
+                continue;
+
+            std::fill(fftBuffer.begin(), fftBuffer.end(), 0.0f);
+            for (int i = 0; i < length; ++i)
+                fftData[i] = (float) (samples[i] * (i - centre) / blockSize);
+
+            transformInto(stage.spectra->ramp[(size_t) c], p);
+        }
+    }
+
+    stage.spectra->ready.store(true, std::memory_order_release);
+    return true;
+}
+
+void PartitionedConvolver::setDecayTime(float decayTimeSeconds) noexcept
+{
+    targetDecayTime.store(decayTimeSeconds, std::memory_order_relaxed);
+
+    if (highBand != nullptr)
+        highBand->setDecayTime(decayTimeSeconds * scheme.highBandDecayRatio);
+}
+
+void PartitionedConvolver::setEarlyLateGains(float newEarlyGain, float newLateGain) noexcept
+{
+    earlyGain.store(newEarlyGain, std::memory_order_relaxed);
+    lateGain.store(newLateGain, std::memory_order_relaxed);
+
+    if (highBand != nullptr)
+        highBand->setEarlyLateGains(newEarlyGain, newLateGain);
+}
+
+void PartitionedConvolver::updateDecay(int numSamples) noexcept
+{
+    const auto decayTime = (double) targetDecayTime.load(std::memory_order_relaxed);
+    const auto target = decayTime > 0.0 ? decayConstant / (decayTime * sampleRate) : 0.0;
+
+    if (target == decayRate && ! snapToTargets)
+        return;
+
+    // straight after a load or a reset there's nothing to glide from, so we jump.
+    if (snapToTargets)
+    {
+        decayRate = target;
+    }
+    else
+    {
+        decayRate += (target - decayRate) * (1.0 - std::exp(-numSamples / (decaySmoothingTime * sampleRate)));
+
+        if (std::abs(target - decayRate) <= 1.0e-4 * juce::jmax(target, decayRate) || std::abs(target - decayRate) < 1.0e-12)
+            decayRate = target;
+    }
+
+    // the energy of what we're actually convolving the tail with: every active partition, with
+    // its gain and ramp.
+    for (auto& segment : segments)
+        std::fill(segment.decayingEnergies.begin(), segment.decayingEnergies.end(), 0.0);
+
+    int numActive = 0;
+    for (auto& stage : stages)
+    {
+        const auto gains = getStageGains(*stage);
+        numActive += stage->activeCounts[(size_t) gains.numActivePartitions];
+
+        if (! stage->decays)
+            continue;
+
+        const double ramp = gains.ramp;
+
+        for (int c = 0; c < numImpulseResponseChannels; ++c)
+        {
+            const auto* moments = stage->partitionMoments[(size_t) c].data();
+            double gain = gains.gain, energy = 0.0;
+
+            for (int p = 0; p < gains.numActivePartitions; ++p)
+            {
+                const auto* m = moments + (size_t) p * 3;
+                energy += gain * gain * (m[0] + 2.0 * ramp * m[1] + ramp * ramp * m[2]);
+                gain *= gains.step;
+            }
+
+            segments[(size_t) stage->segment].decayingEnergies[(size_t) c] += energy;
+        }
+    }
+
+    numActivePartitions.store(numActive, std::memory_order_relaxed);
+
+    // and the network's, which is its power on each path times the square of its decay: the
+    // crossfade a sample at a time, and a geometric series for everything after it.
+    if (feedbackStartSample >= 0 && decayRate > 0.0)
+    {
+        const auto step = std::exp(-2.0 * decayRate);
+        auto envelope = std::exp(-2.0 * decayRate * (feedbackStartSample - decayOrigin));
+        double energy = 0.0;
+
+        for (auto weight : feedbackWeights)
+        {
+            energy += weight * envelope;
+            envelope *= step;
+        }
+
+        energy += envelope / (1.0 - step);
+
+        for (int c = 0; c < numImpulseResponseChannels; ++c)
+            segments[(size_t) feedbackSegment].decayingEnergies[(size_t) c] += feedbackPowers[(size_t) c] * energy;
+    }
+}
+
+void PartitionedConvolver::updateSegmentGains() noexcept
+{
+    // without a late start, it's all one segment and the early/late balance doesn't apply.
+    float gains[numSegments] = { 1.0f, 1.0f };
+    if (lateStartSample >= 0)
+    {
+        const auto early = earlyGain.load(std::memory_order_relaxed);
+        const auto late = lateGain.load(std::memory_order_relaxed);
+        gains[0] = lateFirst ? late : early;
+        gains[1] = lateFirst ? early : late;
+    }
+
+    // matching juce::dsp::Convolution's Normalise::yes, so the wet level stays where it's always
+    // been -- only now it's the energy of the IR as we're actually hearing it. in true stereo
+    // every output sums two (uncorrelated) paths, so we take another 3dB off to keep the level
+    // the same as plain stereo.
+    auto normalisation = 1.0f;
+    if (normalising)
+    {
+        double maxEnergy = 0.0;
+        for (int c = 0; c < numImpulseResponseChannels; ++c)
+        {
+            double energy = 0.0;
+            for (int s = 0; s < numSegments; ++s)
+            {
+                const auto& segment = segments[(size_t) s];
+                energy += (double) gains[s] * gains[s] * (segment.fixedEnergies[(size_t) c] + segment.decayingEnergies[(size_t) c]);
+            }
+
+            maxEnergy = juce::jmax(maxEnergy, energy);
+        }
+
+        if (maxEnergy > 0.0)
+            normalisation = (float) (0.125 / std::sqrt(maxEnergy));
+
+        if (trueStereo)
+            normalisation *= juce::MathConstants<float>::sqrt2 * 0.5f;
+    }
+    else
+    {
+        normalisation = fixedNormalisation;
+    }
+
+    if (highBand != nullptr)
+        highBand->fixedNormalisation = normalisation * highBandGain;
+
+    if (snapToTargets)
+        reflectionGain.setCurrentAndTargetValue(gains[0] * normalisation);
+    else
+        reflectionGain.setTargetValue(gains[0] * normalisation);
+
+    for (int s = 0; s < numSegments; ++s)
+    {
+        auto& gain = segments[(size_t) s].gain;
+        const auto target = gains[s] * normalisation;
+
+        if (snapToTargets)
+            gain.setCurrentAndTargetValue(target);
+        else
+            gain.setTargetValue(target);
+    }
+
+    snapToTargets = false;
+}
+
+PartitionedConvolver::StageGains PartitionedConvolver::getStageGains(const Stage& stage) const noexcept
+{
+    StageGains gains;
+    gains.numActivePartitions = stage.numPartitions;
+
+    if (! stage.decays || decayRate <= 0.0)
+        return gains;
+
+    // partitions that start past the -60dB point are left out -- that's where the IR used to
+    // stop when the decay was baked into it.
+    const double blockSize = stage.blockSize;
+    const double end = decayOrigin + decayConstant / decayRate;
+    gains.numActivePartitions = juce::jlimit(0, stage.numPartitions, (int) std::ceil((end - stage.offset) / blockSize));
+
+    if (gains.numActivePartitions == 0)
+        return gains;
+
+    // partition p covers samples O + pB + i, where the envelope is exp(-rate * t). that's the
+    // envelope at the partition's middle, times exp(-x * u) across it, with x = rate * B and u
+    // running from -1/2 to 1/2. a least-squares straight line a + b * u through the latter is
+    // plenty for how far the envelope moves within one partition: a scales the partition and b
+    // is how much of its ramp spectrum gets added in. the middle of each partition is exp(-x)
+    // down on the one before, so that's the step.
+    const double x = decayRate * blockSize;
+    double a = 1.0, b = -x;
+
+    if (x > 1.0e-3)
+    {
+        a = std::sinh(0.5 * x) / (0.5 * x);
+        b = 12.0 * (2.0 * std::sinh(0.5 * x) / (x * x) - std::cosh(0.5 * x) / x);
+    }
+
+    gains.gain = (float) (a * std::exp(-decayRate * (stage.offset - decayOrigin + 0.5 * (blockSize - 1))));
+    gains.step = (float) std::exp(-x);
+    gains.ramp = (float) (b / a);
+
+    if (std::abs(gains.ramp) < minimumRamp)
+        gains.ramp = 0.0f;
+
+    return gains;
+}
+
+void PartitionedConvolver::reset()
+{
+    cancelPendingWork();
+
+    inputHistory.clear();
+    firInput.clear();
+
+    for (auto& segment : segments)
+        segment.ring.clear();
+
+    for (auto& stage : stages)
+    {
+        for (auto& spectra : stage->inputSpectra)
+            std::fill(spectra.begin(), spectra.end(), 0.0f);
+
+        stage->newestInput = 0;
+    }
+
+    if (scheme.decimation > 1)
+    {
+        decimator.reset();
+        interpolator.reset();
+    }
+
+    if (highBand != nullptr)
+        highBand->reset();
+
+    reflectionDelay.reset();
+    feedbackNetwork.reset();
+    samplesProcessed = 0;
+    snapToTargets = true;
+}
+
+void PartitionedConvolver::cancelPendingWork()
+{
+    for (auto& stage : stages)
+    {
+        if (stage->task != nullptr)
+            workerPool->cancel(*stage->task);
+
+        stage->pendingTime = -1;
+    }
+}
+
+int PartitionedConvolver::getImpulseResponseChannel(int inputChannel, int outputChannel) const noexcept
+{
+    if (trueStereo)
+        return inputChannel * 2 + outputChannel;
+
+    return inputChannel == outputChannel ? juce::jmin(outputChannel, numImpulseResponseChannels - 1) : -1;
+}
+
+int PartitionedConvolver::getNumActivePartitions() const
+{
+    return numActivePartitions.load(std::memory_order_relaxed) + (highBand != nullptr ? highBand->getNumActivePartitions() : 0);
+}
+
+int PartitionedConvolver::getNumPartitions() const
+{
+    int total = highBand != nullptr ? highBand->getNumPartitions() : 0;
+    for (auto& stage : stages)
+        total += stage->numPartitions;
+
+    return total;
+}
+
+size_t PartitionedConvolver::getMemorySize() const
+{
+    auto bufferSize = [](const juce::AudioBuffer<float>& buffer)
+    {
+        return (size_t) buffer.getNumChannels() * (size_t) buffer.getNumSamples() * sizeof(float);
+    };
+
+    auto spectraSize = [](const std::vector<std::vector<float>>& spectra)
+    {
+        size_t total = 0;
+        for (auto& s : spectra)
+            total += s.size() * sizeof(float);
+
+        return total;
+    };
+
+    size_t total = bufferSize(inputHistory) + bufferSize(firTaps) + bufferSize(firInput);
+
+    if (highBand != nullptr)
+        total += highBand->getMemorySize() + bufferSize(highBandBuffer);
+
+    for (auto& segment : segments)
+        total += bufferSize(segment.ring);
+
+    if (hasFeedbackTail())
+        total += feedbackNetwork.getMemorySize() + bufferSize(feedbackBuffer);
+
+    for (auto& stage : stages)
+        total += stage->spectra->getSizeInBytes() + spectraSize(stage->inputSpectra)
+               + bufferSize(stage->output) + (stage->fftBuffer.size() + stage->accumulator.size()) * sizeof(float);
+
+    return total;
+}
+
+void PartitionedConvolver::process(const juce::dsp::ProcessContextReplacing<float>& context) noexcept
+{
+    auto& block = context.getOutputBlock();
+    const bool hasReflections = reflectionDelay.getNumTaps() > 0;
+
+    if (hasReflections)
+        renderReflections(block);
+
+    if (scheme.decimation == 1)
+        processPartitions(block);
+    else
+        processDecimated(block);
+
+    if (hasReflections)
+        addReflections(block);
+}
+
+void PartitionedConvolver::renderReflections(const juce::dsp::AudioBlock<float>& block) noexcept
+{
+    const auto numSamples = (int) block.getNumSamples();
+    const auto channels = juce::jmin((int) block.getNumChannels(), numChannels);
+
+    for (int c = 0; c < channels; ++c)
+        hostChannels[(size_t) c] = block.getChannelPointer((size_t) c);
+
+    reflectionDelay.pushInput(hostChannels.data(), channels, numSamples);
+
+    for (int c = 0; c < channels; ++c)
+    {
+        auto* output = reflectionBuffer.getWritePointer(c);
+        juce::FloatVectorOperations::clear(output, numSamples);
+
+        for (int input = 0; input < channels; ++input)
+            if (const int path = getImpulseResponseChannel(input, c); path >= 0)
+                reflectionDelay.addPath(input, path, output, numSamples);
+    }
+}
+
+void PartitionedConvolver::addReflections(juce::dsp::AudioBlock<float>& block) noexcept
+{
+    const auto numSamples = (int) block.getNumSamples();
+    const auto channels = juce::jmin((int) block.getNumChannels(), numChannels);
+
+    for (int i = 0; i < numSamples; ++i)
+        reflectionGains[(size_t) i] = reflectionGain.getNextValue();
+
+    for (int c = 0; c < channels; ++c)
+        juce::FloatVectorOperations::addWithMultiply(block.getChannelPointer((size_t) c), reflectionBuffer.getReadPointer(c),
+                                                     reflectionGains.data(), numSamples);
+}
+
+void PartitionedConvolver::processDecimated(juce::dsp::AudioBlock<float>& block) noexcept
+{
+    // down through the decimator, through the partitions at the lower rate, and back up. the
+    // filters keep their own count of where they are, so the host's blocks don't have to be a
+    // multiple of the factor.
+    const auto numSamples = (int) block.getNumSamples();
+    const auto channels = juce::jmin((int) block.getNumChannels(), numChannels);
+
+    for (int c = 0; c < channels; ++c)
+        hostChannels[(size_t) c] = block.getChannelPointer((size_t) c);
+
+    for (auto c = (size_t) channels; c < block.getNumChannels(); ++c)
+        juce::FloatVectorOperations::clear(block.getChannelPointer(c), numSamples);
+
+    if (highBand != nullptr)
+        for (int c = 0; c < channels; ++c)
+            highBandBuffer.copyFrom(c, 0, hostChannels[(size_t) c], numSamples);
+
+    const int numDecimated = decimator.process(hostChannels.data(), decimatedBuffer.getArrayOfWritePointers(), channels, numSamples);
+
+    juce::dsp::AudioBlock<float> decimatedBlock(decimatedBuffer.getArrayOfWritePointers(), (size_t) channels, (size_t) numDecimated);
+    processPartitions(decimatedBlock);
+
+    interpolator.process(decimatedBuffer.getArrayOfReadPointers(), numDecimated, hostChannels.data(), channels, numSamples);
+
+    // the high band goes after us, as it takes its normalisation from ours.
+    if (highBand != nullptr)
+    {
+        juce::dsp::AudioBlock<float> highBandBlock(highBandBuffer.getArrayOfWritePointers(), (size_t) channels, (size_t) numSamples);
+        highBand->process(juce::dsp::ProcessContextReplacing<float>(highBandBlock));
+
+        for (int c = 0; c < channels; ++c)
+            juce::FloatVectorOperations::add(hostChannels[(size_t) c], highBandBuffer.getReadPointer(c), numSamples);
+    }
+}
+
+void PartitionedConvolver::processPartitions(juce::dsp::AudioBlock<float>& block) noexcept
+{
+    const auto numSamples = block.getNumSamples();
+    const auto channels = juce::jmin(block.getNumChannels(), (size_t) numChannels);
+
+    // the gains are kept up to date even with nothing to run, as the reflections follow them.
+    updateDecay((int) numSamples);
+    updateSegmentGains();
+
+    if (hasFeedbackTail())
+        feedbackNetwork.setDecayRate(decayRate);
+
+    if (stages.empty() && (firLength == 0 || firIsSilent) && ! hasFeedbackTail())
+    {
+        block.clear();
+        return;
+    }
+
+    // anything past the channels we were prepared for gets silence.
+    for (auto c = channels; c < block.getNumChannels(); ++c)
+        juce::FloatVectorOperations::clear(block.getChannelPointer(c), (int) numSamples);
+
+    const auto headBlockSize = (juce::int64) scheme.headBlockSize;
+    const auto latency = (juce::int64) scheme.getPartitionLatency();
+    const bool runsFir = firLength > 0 && ! firIsSilent;
+
+    // work through the block a head partition at a time (or less, if the host's blocks don't line
+    // up with ours): push the input into the history, pull the output that's due out of the ring,
+    // and run the stages every time a head block fills up.
+    size_t done = 0;
+    while (done < numSamples)
+    {
+        const auto positionInHeadBlock = samplesProcessed & (headBlockSize - 1);
+        const auto count = (size_t) juce::jmin((juce::int64) (numSamples - done), headBlockSize - positionInHeadBlock);
+
+        // each segment's gain for every sample of the chunk, so the channels all follow the same
+        // curve.
+        for (int s = 0; s < numSegments; ++s)
+        {
+            auto& gain = segments[(size_t) s].gain;
+            auto* gains = segmentGainBuffer.getWritePointer(s);
+
+            for (size_t i = 0; i < count; ++i)
+                gains[i] = gain.getNextValue();
+        }
+
+        const auto* earlyGains = segmentGainBuffer.getReadPointer(0);
+        const auto* lateGains = segmentGainBuffer.getReadPointer(1);
+
+        // in true stereo each output's FIR reads both inputs, so they all go in before any
+        // channel gets overwritten with its output.
+        if (runsFir)
+            for (size_t c = 0; c < channels; ++c)
+                juce::FloatVectorOperations::copy(firInput.getWritePointer((int) c) + firLength - 1,
+                                                  block.getChannelPointer(c) + done, (int) count);
+
+        for (size_t c = 0; c < channels; ++c)
+        {
+            auto* io = block.getChannelPointer(c) + done;
+            auto* history = inputHistory.getWritePointer((int) c);
+            auto* early = segments[0].ring.getWritePointer((int) c);
+            auto* late = segments[1].ring.getWritePointer((int) c);
+            const auto earlyMask = segments[0].mask;
+            const auto lateMask = segments[1].mask;
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                const auto time = samplesProcessed + (juce::int64) i;
+                history[time & historyMask] = io[i];
+
+                // read-and-clear, so the slot's ready to be accumulated into again.
+                auto& due = early[(time - latency) & earlyMask];
+                io[i] = due;
+                due = 0.0f;
+            }
+
+            // the direct part: one vectorised multiply-add across the chunk per tap, for every
+            // input that feeds this output.
+            for (size_t input = 0; input < channels && runsFir; ++input)
+            {
+                const int irChannel = getImpulseResponseChannel((int) input, (int) c);
+                if (irChannel < 0)
+                    continue;
+
+                const auto* fir = firInput.getReadPointer((int) input);
+                const auto* taps = firTaps.getReadPointer(irChannel);
+
+                for (int k = 0; k < firLength; ++k)
+                    juce::FloatVectorOperations::addWithMultiply(io, fir + firLength - 1 - k, taps[k], (int) count);
+            }
+
+            // and now that the first segment's all in, the two get their gains and summed.
+            for (size_t i = 0; i < count; ++i)
+            {
+                auto& due = late[(samplesProcessed + (juce::int64) i - latency) & lateMask];
+                io[i] = io[i] * earlyGains[i] + due * lateGains[i];
+                due = 0.0f;
+            }
+        }
+
+        if (hasFeedbackTail())
+            processFeedbackTail((int) count);
+
+        // slide the FIR input along so the next chunk has the history it needs.
+        if (runsFir)
+            for (size_t c = 0; c < channels; ++c)
+            {
+                auto* fir = firInput.getWritePointer((int) c);
+                std::memmove(fir, fir + count, sizeof(float) * (size_t) (firLength - 1));
+            }
+
+        samplesProcessed += (juce::int64) count;
+        done += count;
+
+        if ((samplesProcessed & (headBlockSize - 1)) == 0)
+            processStages(samplesProcessed);
+    }
+}
+
+void PartitionedConvolver::processFeedbackTail(int numSamples) noexcept
+{
+    // the chunk never crosses a head block boundary, so it's all in one run of the history.
+    const auto historyStart = samplesProcessed & historyMask;
+    for (int c = 0; c < numChannels; ++c)
+        feedbackInputs[(size_t) c] = inputHistory.getReadPointer(c) + historyStart;
+
+    // the network's decay starts from its input, so the input gets what the decay's already
+    // taken off by the feedback start. with no decay, there's no tail for it to take over.
+    const auto inputGain = decayRate > 0.0 ? (float) std::exp(-decayRate * (feedbackStartSample - decayOrigin)) : 0.0f;
+    feedbackNetwork.process(feedbackInputs.data(), feedbackBuffer.getArrayOfWritePointers(), numSamples, inputGain);
+
+    auto& segment = segments[(size_t) feedbackSegment];
+    const auto ringStart = samplesProcessed + feedbackStartSample;
+
+    for (int c = 0; c < numChannels; ++c)
+    {
+        auto* ring = segment.ring.getWritePointer(c);
+        const auto* output = feedbackBuffer.getReadPointer(c);
+
+        for (int i = 0; i < numSamples; ++i)
+            ring[(ringStart + i) & segment.mask] += output[i];
+    }
+}
+
+void PartitionedConvolver::processStages(juce::int64 time) noexcept
+{
+    for (auto& s : stages)
+    {
+        auto& stage = *s;
+
+        if ((time & (stage.blockSize - 1)) != 0)
+            continue;
+
+        // the run we sent out a block ago is due now. if no worker has picked it up yet, this is
+        // where it gets done instead.
+        if (stage.pendingTime >= 0)
+        {
+            workerPool->complete(*stage.task);
+            commitStage(stage, stage.pendingTime);
+            stage.pendingTime = -1;
+        }
+
+        stage.newestInput = (stage.newestInput + 1) % stage.numPartitions;
+
+        // a stage that's still waiting on its spectra runs as if it were past the end of the
+        // decay -- it keeps its delay line going, and nothing else.
+        auto gains = getStageGains(stage);
+        if (! stage.spectra->ready.load(std::memory_order_acquire))
+            gains.numActivePartitions = 0;
+
+        if (stage.runsOnWorker)
+        {
+            // it has to be back before the stage runs again, one block from now.
+            const auto deadline = juce::Time::getMillisecondCounterHiRes() + 1000.0 * stage.blockSize / sampleRate;
+            stage.task->time = time;
+            stage.task->gains = gains;
+
+            if (workerPool->submit(*stage.task, deadline))
+            {
+                stage.pendingTime = time;
+                continue;
+            }
+        }
+
+        runStage(stage, time, gains);
+        commitStage(stage, time);
+    }
+}
+
+void PartitionedConvolver::runStage(Stage& stage, juce::int64 time, const StageGains& gains) noexcept
+{
+    // a stage that's wholly past the end of the decay just keeps its delay line up to date, in
+    // case the decay gets longer again.
+    const bool isSilent = gains.numActivePartitions == 0;
+
+    // a stereo pair shares one complex transform each way, which halves the FFT work.
+    if (numChannels == 2)
+    {
+        transformStereoInput(stage, time);
+
+        if (! isSilent)
+        {
+            accumulatePartitions(stage, 0, gains);
+            accumulatePartitions(stage, 1, gains);
+            transformStereoOutput(stage);
+        }
+    }
+    else
+    {
+        for (int c = 0; c < numChannels; ++c)
+        {
+            transformInput(stage, c, time);
+
+            if (! isSilent)
+            {
+                accumulatePartitions(stage, c, gains);
+                transformOutput(stage, c);
+            }
+        }
+    }
+
+    if (isSilent)
+        stage.output.clear();
+}
+
+void PartitionedConvolver::commitStage(Stage& stage, juce::int64 time) noexcept
+{
+    // the output belongs to the B samples before the run, pushed back by this stage's offset
+    // into the IR.
+    const auto writeStart = time - stage.blockSize + stage.offset;
+    auto& segment = segments[(size_t) stage.segment];
+
+    for (int c = 0; c < numChannels; ++c)
+    {
+        const auto* source = stage.output.getReadPointer(c);
+        auto* ring = segment.ring.getWritePointer(c);
+
+        for (int i = 0; i < stage.blockSize; ++i)
+            ring[(writeStart + i) & segment.mask] += source[i];
+    }
+}
+
+void PartitionedConvolver::transformInput(Stage& stage, int channel, juce::int64 time) noexcept
+{
+    const int fftSize = stage.blockSize * 2;
+    const auto spectrumSize = stage.getSpectrumSize();
+    auto* fftData = stage.fftBuffer.data();
+
+    // overlap-save: the spectrum of the last 2B input samples goes in the newest delay line slot.
+    const auto* history = inputHistory.getReadPointer(channel);
+    for (int i = 0; i < fftSize; ++i)
+        fftData[i] = history[(time - fftSize + i) & historyMask];
+
+    std::fill(fftData + fftSize, fftData + fftSize * 2, 0.0f);
+    stage.fft->performRealOnlyForwardTransform(fftData, true);
+
+    auto& delayLine = stage.inputSpectra[(size_t) channel];
+    std::copy(fftData, fftData + spectrumSize, delayLine.begin() + (std::ptrdiff_t) ((size_t) stage.newestInput * spectrumSize));
+}
+
+void PartitionedConvolver::transformStereoInput(Stage& stage, juce::int64 time) noexcept
+{
+    const int fftSize = stage.blockSize * 2;
+    const auto spectrumSize = stage.getSpectrumSize();
+    auto* packed = stage.packedInput.data();
+    auto* spectrum = stage.packedOutput.data();
+
+    // left goes in the real part and right in the imaginary part of one complex frame.
+    const auto* left = inputHistory.getReadPointer(0);
+    const auto* right = inputHistory.getReadPointer(1);
+    for (int i = 0; i < fftSize; ++i)
+    {
+        const auto t = (time - fftSize + i) & historyMask;
+        packed[i] = { left[t], right[t] };
+    }
+
+    stage.fft->perform(packed, spectrum, false);
+
+    // a real signal's spectrum is conjugate-symmetric, so with Z = L + iR:
+    //
+    //   L[k] = (Z[k] + conj(Z[N - k])) / 2
+    //   R[k] = (Z[k] - conj(Z[N - k])) / 2i
+    auto* leftSpectrum = stage.inputSpectra[0].data() + (size_t) stage.newestInput * spectrumSize;
+    auto* rightSpectrum = stage.inputSpectra[1].data() + (size_t) stage.newestInput * spectrumSize;
+
+    for (int k = 0; k < stage.numBins; ++k)
+    {
+        const auto z = spectrum[k];
+        const auto mirror = spectrum[(fftSize - k) & (fftSize - 1)];
+
+        leftSpectrum[2 * k]      = 0.5f * (z.real() + mirror.real());
+        leftSpectrum[2 * k + 1]  = 0.5f * (z.imag() - mirror.imag());
+        rightSpectrum[2 * k]     = 0.5f * (z.imag() + mirror.imag());
+        rightSpectrum[2 * k + 1] = 0.5f * (mirror.real() - z.real());
+    }
+}
+
+void PartitionedConvolver::accumulatePartitions(Stage& stage, int channel, const StageGains& gains) noexcept
+{
+    const auto spectrumSize = stage.getSpectrumSize();
+    auto* accumulator = stage.accumulator.data() + (size_t) channel * spectrumSize;
+    std::fill(accumulator, accumulator + spectrumSize, 0.0f);
+
+    // multiply each partition by the input from that many blocks ago, and sum -- over every
+    // input that feeds this output. the input spectra are shared, so true stereo doubles the
+    // work here but doesn't need a single extra FFT.
+    for (int input = 0; input < numChannels; ++input)
+    {
+        const int irChannel = getImpulseResponseChannel(input, channel);
+        if (irChannel < 0)
+            continue;
+
+        const auto& delayLine = stage.inputSpectra[(size_t) input];
+        const auto& impulseResponse = stage.spectra->impulseResponse[(size_t) irChannel];
+        const auto& ramps = stage.spectra->ramp[(size_t) irChannel];
+        auto gain = gains.gain;
+
+        for (int p = 0; p < gains.numActivePartitions; ++p, gain *= gains.step)
+        {
+            if (! stage.activePartitions[(size_t) p])
+                continue;
+
+            const int slot = (stage.newestInput - p + stage.numPartitions) % stage.numPartitions;
+            const auto* spectrum = delayLine.data() + (size_t) slot * spectrumSize;
+
+            multiplyAccumulate(accumulator, spectrum, impulseResponse.data() + (size_t) p * spectrumSize, gain, stage.numBins);
+
+            if (gains.ramp != 0.0f)
+                multiplyAccumulate(accumulator, spectrum, ramps.data() + (size_t) p * spectrumSize, gain * gains.ramp, stage.numBins);
+        }
+    }
+}
+
+void PartitionedConvolver::transformOutput(Stage& stage, int channel) noexcept
+{
+    const int blockSize = stage.blockSize;
+    const int fftSize = blockSize * 2;
+    const auto spectrumSize = stage.getSpectrumSize();
+    const auto* accumulator = stage.accumulator.data() + (size_t) channel * spectrumSize;
+    auto* fftData = stage.fftBuffer.data();
+
+    // the inverse transform wants the whole spectrum, so fill in the negative frequencies as the
+    // conjugate mirror of the positive ones.
+    std::copy(accumulator, accumulator + spectrumSize, fftData);
+    for (int bin = 1; bin < blockSize; ++bin)
+    {
+        fftData[2 * (fftSize - bin)]     =  accumulator[2 * bin];
+        fftData[2 * (fftSize - bin) + 1] = -accumulator[2 * bin + 1];
+    }
+
+    stage.fft->performRealOnlyInverseTransform(fftData);
+
+    // the second half is the valid part.
+    stage.output.copyFrom(channel, 0, fftData + blockSize, blockSize);
+}
+
+void PartitionedConvolver::transformStereoOutput(Stage& stage) noexcept
+{
+    const int blockSize = stage.blockSize;
+    const int fftSize = blockSize * 2;
+    const auto spectrumSize = stage.getSpectrumSize();
+    const auto* left = stage.accumulator.data();
+    const auto* right = left + spectrumSize;
+    auto* packed = stage.packedInput.data();
+    auto* result = stage.packedOutput.data();
+
+    // the reverse of the input side: build the full spectrum of L + iR, whose inverse has the
+    // left output in its real part and the right in its imaginary part. the negative frequencies
+    // come from each channel's conjugate mirror.
+    for (int k = 0; k < stage.numBins; ++k)
+    {
+        const auto lr = left[2 * k], li = left[2 * k + 1];
+        const auto rr = right[2 * k], ri = right[2 * k + 1];
+
+        packed[k] = { lr - ri, li + rr };
+
+        if (k > 0 && k < blockSize)
+            packed[fftSize - k] = { lr + ri, rr - li };
+    }
+
+    stage.fft->perform(packed, result, true);
+
+    // the second half is the valid part.
+    auto* leftOutput = stage.output.getWritePointer(0);
+    auto* rightOutput = stage.output.getWritePointer(1);
+    for (int i = 0; i < blockSize; ++i)
+    {
+        leftOutput[i] = result[blockSize + i].real();
+        rightOutput[i] = result[blockSize + i].imag();
+    }
+}
@@ -0,0 +1,462 @@
+/*
+  ==============================================================================
+    PartitionedConvolver.h
+    Created: 17 Oct 2026
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ConvolutionWorkerPool.h"
+#include "FeedbackDelayNetwork.h"
+#include "PolyphaseResampling.h"
+#include "SparseTapDelay.h"
+#include "SpectralKernels.h"
+
+// our own convolution engine, built for the long (up to 20s) IRs this plugin makes.
+//
+// it's a non-uniformly partitioned convolver in the Gardner / Garcia style: the head of the IR is
+// cut into small partitions, so the latency stays low, and each stage after that uses partitions
+// `growthFactor` times bigger than the one before. big partitions mean big FFTs that run rarely,
+// so the tail -- which is almost all of the IR -- costs a tiny fraction of what it would if the
+// whole thing were cut up at the head size. every stage is a plain uniformly partitioned
+// overlap-save convolver with a frequency-domain delay line, running on its own schedule; their
+// outputs land in a shared ring buffer at the right offsets and get read out from there.
+//
+// for stage s (block size B, starting at sample O of the IR) to finish in time, O + latency has
+// to be at least B. with at least growthFactor - 1 partitions per stage that always holds.
+//
+// when O + latency is at least 2B, a stage's output isn't needed until a whole block after it
+// runs, so instead of computing it inside the audio callback we hand it to the shared
+// ConvolutionWorkerPool with a deadline, and pick the result up a block later. with the default
+// scheme that's every stage but the head, so only the small head partitions are left on the
+// audio thread. if a worker hasn't got to a stage by the time it's due, the audio thread just
+// does it itself -- the output is exactly the same either way, it only changes who pays for it.
+//
+// there's also a zero-latency mode for live use. the first headBlockSize samples of the IR are
+// run as a plain time-domain FIR (vectorised across each chunk of samples), so the output for
+// an input sample comes out straight away, and the FFT stages pick up from there. as the first
+// stage now starts one head block into the IR, it still meets the deadline above with no
+// latency at all.
+//
+// a four-channel IR on a stereo engine runs as true stereo: the channels are the LL, LR, RL and
+// RR paths, so each input feeds both outputs. every input still only gets transformed once per
+// block and its spectra are shared by both of its paths, so it's twice the multiply-adds of
+// plain stereo but no more FFTs.
+//
+// the decay can also be left to us. load an IR with a decay start, and everything from there on
+// is taken to be the tail with no decay applied; setDecayTime() then puts an exponential decay
+// on it by scaling the tail's partitions as they're summed, rather than by making a new IR. each
+// partition gets the envelope at its middle, plus some of a second "ramp" spectrum for the slope
+// across it, and partitions past the -60dB point are skipped altogether. the decay time
+// glides to a new value over a few blocks, and the normalisation follows it, so changing it
+// is click-free and costs next to nothing.
+//
+// in the same way, an IR can be split into its early and late parts, each of which gets its own
+// output ring. they're summed as they're read out, with a smoothed gain each (and the
+// normalisation updated to match), so the balance between them can be moved every block, with
+// nothing to rebuild.
+//
+// the whole thing can also run at a fraction of the host rate, for the lower quality modes. the
+// input goes through a polyphase decimator first and the output through a matching interpolator,
+// and everything in between -- the IR included -- is at the lower rate. a quarter of the rate is
+// a quarter of the partitions, each a quarter of the size, so it's far cheaper than the pair of
+// filters it costs.
+//
+// decimating loses everything above the lower rate's Nyquist, though. with splitBands, that top
+// band gets an engine of its own, at the full rate, with an IR of its own and a shorter decay --
+// so the highs die away sooner, the way they do in a real room, and only the low band has to
+// carry the whole length of the tail. there's no crossover on the input: the high band's IR is
+// put through the complement of the resampling filters instead (itself, delayed, minus itself
+// through both of them), so the two bands always add back up to the full band exactly. its
+// partitions start bigger, too, to line its latency up with ours.
+//
+// the early reflections can be left out of the IR and handed over as taps instead, for a
+// SparseTapDelay to play at the host rate. they count towards the normalisation and the early
+// gain just as they would in the IR, but with them gone, the start of the IR is silent -- and a
+// stage whose part of the IR is silent all the way through is never built, so there's no head
+// partition work for them at all.
+//
+// and past a feedback start, the tail can be left to a FeedbackDelayNetwork altogether. by then
+// the IR is just decaying noise, so the network only has to match its level and its tilt: its
+// input gain on each path is set so its response has the same power as that path's tail, and its
+// lowpass so the two have the same correlation from one sample to the next. the IR gets cut off
+// a short crossfade past the feedback start, and the crossfade is baked into what's left of it --
+// the IR fading out, plus the network's own (known) response subtracted where the network is
+// still fading in -- so that the network, which starts at full level, adds up to a clean
+// crossfade from one to the other. it runs on the decay rate we're gliding along, so from there
+// on the tail costs the same however long it rings for.
+//
+// and wherever the decay isn't ours -- a reverse IR, say, which starts out near silent -- the
+// quietest partitions are skipped altogether. each partition's energy is worked out on loading,
+// and everything below a level is left out: the highest level at which all that's left out adds
+// up to no more than partitionSkipDecibels below the IR. a skipped partition gets no spectrum and
+// no multiply-add, and a stage with nothing but skipped partitions isn't built at all.
+//
+// everything gets allocated when the IR is loaded -- process() never allocates, and the only
+// lock it touches is the worker queue's spin lock.
+class PartitionedConvolver
+{
+public:
+    struct Scheme
+    {
+        int headBlockSize = 128;        // the smallest partition size, which is also the latency.
+        int growthFactor = 4;           // each stage's partitions are this many times bigger than the last.
+        int partitionsPerStage = 8;     // how many partitions a stage gets before we move up a size.
+        int maximumBlockSize = 8192;    // partitions stop growing here, and the last stage takes the rest.
+        bool useWorkerThreads = true;   // run the tail stages on the worker pool where we can.
+        bool zeroLatency = false;       // run the head as a direct FIR instead, for no latency at all.
+        int decimation = 1;             // run at the host rate divided by this, between resampling filters.
+        bool splitBands = false;        // with decimation, run the band it loses through a second engine.
+        float highBandDecayRatio = 0.5f; // the high band's decay time, as a fraction of ours.
+        float partitionSkipDecibels = -50.0f; // quiet partitions are skipped, so long as all of them add up to this much less than the IR.
+
+        // the latency of the partitioned part, at the rate it runs at, and then of the whole
+        // engine at the host rate, with the resampling filters (if there are any) included. the
+        // filters can't be made latency-free, so decimating gives up the zero-latency mode's
+        // whole point.
+        int getPartitionLatency() const { return zeroLatency ? 0 : headBlockSize; }
+        int getLatency() const { return getPartitionLatency() * decimation + PolyphaseResampling::getLatency(decimation); }
+    };
+
+    // the parts of the IR we can change on the fly, in seconds into the IR. negative means
+    // there isn't one. the first two get moved to a head block boundary.
+    struct Layout
+    {
+        double decayStart = -1.0;       // from here on, the decay is left to setDecayTime().
+        double lateStart = -1.0;        // where the early part ends and the late part begins.
+        bool lateFirst = false;         // for a reversed IR: the late part comes before the split.
+        double end = -1.0;              // anything past here is left out, as if the IR stopped.
+        double deferredStart = -1.0;    // stages from here on are left for loadDeferredStages().
+        double feedbackStart = -1.0;    // from here on, the tail is left to a feedback delay network.
+
+        // reflections that aren't in the IR, to be played alongside it. they're taken to be part
+        // of the first segment, and to come before the decay start.
+        SparseTapDelay::Taps reflections;
+    };
+
+    // the partition spectra of a loaded IR -- nearly all of the work of loading one, and most of
+    // the memory it takes. get them with getSpectra(), and another engine loading the same IR with
+    // the same scheme and layout can be handed them, and share them instead of doing the
+    // transforms again. nothing writes to them once they're complete, so any number of engines
+    // (and a cache) can hold on to them at once.
+    class Spectra
+    {
+    public:
+        // whether every stage has its spectra -- the deferred ones and the high band's included.
+        bool isComplete() const;
+        size_t getSizeInBytes() const;
+
+        // one stage's worth. only the engine needs to see inside it.
+        struct StageSpectra;
+
+    private:
+        friend class PartitionedConvolver;
+
+        std::vector<std::shared_ptr<StageSpectra>> stages;
+        std::shared_ptr<const Spectra> highBand;
+    };
+
+    PartitionedConvolver();
+    explicit PartitionedConvolver(const Scheme& scheme);
+    ~PartitionedConvolver();
+
+    void prepare(const juce::dsp::ProcessSpec& spec);
+
+    // splits the IR into stages and works out every partition's spectrum. the IR is resampled to
+    // the rate we were prepared with if it was made at a different one, and normalised the same
+    // way juce::dsp::Convolution does it, so the wet level stays where it's always been. a mono IR
+    // is used for every channel, and a four-channel one is true stereo (see above). the buffer is
+    // only read, never kept. call after prepare(), and never from the audio thread.
+    //
+    // if spectra are given, from an earlier load of the same IR with the same scheme and layout,
+    // every stage that lines up with one of theirs takes its spectra from there instead of doing
+    // the transforms. anything that doesn't match is just worked out as usual.
+    void loadImpulseResponse(const juce::AudioBuffer<float>& impulseResponse, double impulseResponseSampleRate,
+                             bool normalise, const Layout& layout, const std::shared_ptr<const Spectra>& spectra = nullptr);
+
+    void loadImpulseResponse(const juce::AudioBuffer<float>& impulseResponse, double impulseResponseSampleRate, bool normalise = true)
+    {
+        loadImpulseResponse(impulseResponse, impulseResponseSampleRate, normalise, Layout());
+    }
+
+    // with splitBands: the IR for the band above our decimated one, which is resampled to the
+    // host rate if it isn't at it already. it takes a layout of its own, but in the same terms as
+    // ours, and it's levelled against our IR -- so load it after loadImpulseResponse(), every
+    // time. the same rules apply otherwise -- spectra are the whole engine's, as for ours, and
+    // it takes the high band's from them.
+    void loadHighBandImpulseResponse(const juce::AudioBuffer<float>& impulseResponse, double impulseResponseSampleRate,
+                                     const Layout& layout, const std::shared_ptr<const Spectra>& spectra = nullptr);
+
+    // with a deferred start in the layout, only the stages before it get their spectra worked
+    // out by loadImpulseResponse(). the rest are set up, but stay silent (with the normalisation
+    // already counting them) until loadDeferredStages() does the transforms -- which it can do
+    // on a background thread while we're running, so a long IR can start playing as soon as its
+    // head is ready. the tail comes in a stage at a time, each one with the input it's missed.
+    //
+    // claim the deferred stages first, and then load them. the claim has to come while nothing
+    // else can delete us (before we're handed over, say), as from then on the destructor waits
+    // for the loading to finish. returns false if there's nothing to claim. the high band's
+    // stages come along with ours.
+    bool claimDeferredStages();
+    void loadDeferredStages(const std::function<bool()>& shouldStop = nullptr);
+
+    // the time for the tail to fall by 60dB, measured from the start of the IR. zero (the
+    // default) leaves the tail as it was loaded. safe to call from any thread.
+    void setDecayTime(float decayTimeSeconds) noexcept;
+
+    // the gains on the early and late parts of the IR, before normalisation. they only do
+    // anything if the layout has a late start. safe to call from any thread.
+    void setEarlyLateGains(float earlyGain, float lateGain) noexcept;
+
+    void reset();
+    void process(const juce::dsp::ProcessContextReplacing<float>& context) noexcept;
+
+    int getLatency() const { return scheme.getLatency(); }
+
+    // the IR length (at the processing rate, and after the layout's end), and how it's been
+    // split up.
+    int getImpulseResponseLength() const { return impulseResponseLength; }
+    double getImpulseResponseLengthInSeconds() const { return impulseResponseLength / sampleRate; }
+    int getNumStages() const { return (int) stages.size(); }
+    int getNumPartitions() const;
+
+    // how many of those are being run right now, with the quiet ones and the ones past the end of
+    // the decay left out. safe to call from any thread.
+    int getNumActivePartitions() const;
+    bool isTrueStereo() const { return trueStereo; }
+
+    // whether the tail past the layout's feedback start went to the network. it needs the IR to
+    // run on past the crossfade, a decay start before it, and an IR channel of its own for every
+    // output that the network's response can be taken out of.
+    bool hasFeedbackTail() const { return feedbackStartSample >= 0; }
+
+    // roughly how much memory the loaded IR is holding on to, in bytes -- the spectra and the
+    // buffers that go with them.
+    size_t getMemorySize() const;
+
+    // the loaded IR's spectra, the high band's included. with deferred stages, they aren't
+    // complete until those have been loaded, but they fill in as that goes (even if we've been
+    // deleted by then, so long as the loading finished). not for the audio thread.
+    std::shared_ptr<const Spectra> getSpectra() const { return spectra; }
+
+    const Scheme& getScheme() const { return scheme; }
+
+private:
+    struct Stage;
+    class StageTask;
+
+    // how a stage's partitions get scaled on one run: the first by gain, each after that by step
+    // times the one before, plus ramp times as much of its ramp spectrum. partitions from
+    // numActivePartitions on are left out.
+    struct StageGains
+    {
+        float gain = 1.0f;
+        float step = 1.0f;
+        float ramp = 0.0f;
+        int numActivePartitions = 0;
+    };
+
+    // cached, if it's given and matches the stage, is used for its spectra instead of working
+    // them out.
+    std::unique_ptr<Stage> createStage(const juce::AudioBuffer<float>& impulseResponse, int offset, int blockSize, int numPartitions,
+                                       bool transformNow, const std::shared_ptr<Spectra::StageSpectra>& cached);
+
+    // the level (in mean square, over the loudest IR channel) that a partition we're not decaying
+    // has to be above to be run. everything up to fixedEnd is taken to be ours to skip.
+    double findQuietPartitionLevel(const juce::AudioBuffer<float>& impulseResponse, int fixedEnd) const;
+
+    // works out a stage's partition (and ramp) spectra, from an IR that starts irStart samples
+    // into the whole thing. returns false (with the stage still not ready) if shouldStop fired.
+    bool transformStage(Stage& stage, const juce::AudioBuffer<float>& impulseResponse, int irStart,
+                        const std::function<bool()>& shouldStop = nullptr);
+
+    // sets the network up to take over from the IR at the layout's feedback start, if it can, and
+    // returns the IR to convolve -- which is then blended, a copy of it with the crossfade baked
+    // in, and cut off where the crossfade ends. otherwise it's just ir.
+    const juce::AudioBuffer<float>& prepareFeedbackTail(const juce::AudioBuffer<float>& ir, const Layout& layout,
+                                                        juce::AudioBuffer<float>& blended);
+
+    // the network's output for the chunk that's just gone into the input history, added into the
+    // ring at the feedback start.
+    void processFeedbackTail(int numSamples) noexcept;
+
+    // stops (or waits for) any deferred loading, and lets go of what it was keeping.
+    void finishDeferredLoading();
+
+    // everything process() does, at the rate the partitions run at, and the decimated version
+    // of it, at the host rate.
+    void processPartitions(juce::dsp::AudioBlock<float>& block) noexcept;
+    void processDecimated(juce::dsp::AudioBlock<float>& block) noexcept;
+
+    // runs the reflections' taps over the block's input, and then adds what they made, with
+    // their gain, onto the output.
+    void renderReflections(const juce::dsp::AudioBlock<float>& block) noexcept;
+    void addReflections(juce::dsp::AudioBlock<float>& block) noexcept;
+    void processStages(juce::int64 time) noexcept;
+
+    // moves the decay rate towards the target, working out the tail's energy as it goes, and
+    // then sets each segment's gain (normalisation included) heading for where it should be.
+    void updateDecay(int numSamples) noexcept;
+    void updateSegmentGains() noexcept;
+    StageGains getStageGains(const Stage& stage) const noexcept;
+
+    // works out a stage's output for the block ending at time into its output buffer (this is
+    // the part that can run on a worker), and then adds it into the output ring.
+    void runStage(Stage& stage, juce::int64 time, const StageGains& gains) noexcept;
+    void commitStage(Stage& stage, juce::int64 time) noexcept;
+
+    // the pieces of a run: the input's spectrum into the delay line, the sum over partitions, and
+    // back out to the time domain. the stereo versions pack both channels into the real and
+    // imaginary parts of a single complex transform.
+    void transformInput(Stage& stage, int channel, juce::int64 time) noexcept;
+    void transformStereoInput(Stage& stage, juce::int64 time) noexcept;
+    void accumulatePartitions(Stage& stage, int channel, const StageGains& gains) noexcept;
+    void transformOutput(Stage& stage, int channel) noexcept;
+    void transformStereoOutput(Stage& stage) noexcept;
+
+    // which IR channel takes this input to this output, or -1 if it doesn't feed it at all.
+    int getImpulseResponseChannel(int inputChannel, int outputChannel) const noexcept;
+
+    // takes back anything that's out on the workers. not for the audio thread.
+    void cancelPendingWork();
+
+    const Scheme scheme;
+
+    // the widest complex multiply-accumulate this CPU can run -- it's where nearly all of the
+    // time goes, so it's picked once up front rather than on every call.
+    const SpectralKernels::MultiplyAccumulate multiplyAccumulate;
+
+    // the rate the partitions run at -- the host rate, unless we're decimating.
+    double sampleRate = 44100.0;
+    int numChannels = 0;
+    int impulseResponseLength = 0;
+    int numImpulseResponseChannels = 0;
+    bool trueStereo = false;
+
+    // the IR is split at the late start (if there is one) into two segments: everything before
+    // it, and everything after. each has its own output ring -- indexed by absolute sample time,
+    // like the input history -- and gain, which covers the normalisation as well, since the IR
+    // is stored as it was loaded. fixedEnergies is the energy of the segment's part of each IR
+    // channel that isn't decayed by us, and decayingEnergies what's left of the rest at the
+    // current decay rate.
+    struct Segment
+    {
+        juce::AudioBuffer<float> ring;
+        juce::int64 mask = 0;
+        std::vector<double> fixedEnergies, decayingEnergies;
+        juce::SmoothedValue<float> gain;
+    };
+
+    static constexpr int numSegments = 2;
+    std::array<Segment, numSegments> segments;
+    bool normalising = true;
+
+    // the gain everything gets when we're not normalising -- for a high band, it's whatever its
+    // main engine's normalisation is, passed on every block.
+    float fixedNormalisation = 1.0f;
+
+    // the loaded IR's energy over every energyProfileLength samples, averaged over its channels.
+    // it's what a high band's IR gets levelled against.
+    std::vector<double> energyProfile;
+    int energyProfileLength = 0;
+
+    // where the late part starts (or -1 if there isn't one), which way round it is, and the
+    // gains we're heading for.
+    int lateStartSample = -1;
+    bool lateFirst = false;
+    std::atomic<float> earlyGain { 1.0f }, lateGain { 1.0f };
+
+    // a chunk's worth of each segment's gain, worked out once and shared by every channel.
+    juce::AudioBuffer<float> segmentGainBuffer;
+
+    // where the decaying tail starts (or -1 if there isn't one), the decay time we're heading
+    // for, and the per-sample decay rate we've got to so far. after a load or a reset, the next
+    // block jumps straight to its targets instead of gliding.
+    int decayStartSample = -1;
+    std::atomic<float> targetDecayTime { 0.0f };
+
+    // partitions of ours (outside the decay) no louder than this are skipped, and how many are
+    // being run altogether as of the last decay update.
+    double quietPartitionLevel = 0.0;
+    std::atomic<int> numActivePartitions { 0 };
+
+    // where the decay is measured from. it's the start of the IR, except in a high band, where
+    // the filters have delayed everything a little.
+    int decayOrigin = 0;
+    double decayRate = 0.0;
+    bool snapToTargets = true;
+
+    std::vector<std::unique_ptr<Stage>> stages;
+
+    // every stage's spectra, gathered up to be handed out by getSpectra().
+    std::shared_ptr<Spectra> spectra;
+
+    // the last 2 * (biggest block size) input samples, in a ring indexed by absolute sample time.
+    juce::AudioBuffer<float> inputHistory;
+    juce::int64 historyMask = 0;
+
+    juce::int64 samplesProcessed = 0;
+
+    // zero-latency mode only: the FIR taps for the head of the IR (one set per IR channel), and
+    // a linear buffer per channel holding the last firLength - 1 input samples followed by the
+    // chunk we're working on, so every tap can run across the chunk in one go. if the taps are
+    // all zero, there's nothing to run, but the stages still start after them.
+    int firLength = 0;
+    bool firIsSilent = false;
+    juce::AudioBuffer<float> firTaps;
+    juce::AudioBuffer<float> firInput;
+
+    // the part of the IR the deferred stages are made from (from deferredStart on), kept until
+    // they've been loaded.
+    enum class DeferredLoadState
+    {
+        none,
+        waiting,
+        loading
+    };
+
+    juce::AudioBuffer<float> deferredImpulseResponse;
+    int deferredStart = 0;
+    std::atomic<DeferredLoadState> deferredLoadState { DeferredLoadState::none };
+    std::atomic<bool> abandonDeferredLoading { false };
+
+    // decimating only: the filters either side, and the input at the lower rate.
+    PolyphaseResampling::Decimator decimator;
+    PolyphaseResampling::Interpolator interpolator;
+    juce::AudioBuffer<float> decimatedBuffer;
+
+    // room for the host block's channel pointers.
+    std::vector<float*> hostChannels;
+
+    // the layout's reflections, if it had any: the tap delay, its output for the block (at the
+    // host rate, before its gain), and the gain, which follows the first segment's.
+    SparseTapDelay reflectionDelay;
+    juce::AudioBuffer<float> reflectionBuffer;
+    juce::SmoothedValue<float> reflectionGain;
+    std::vector<float> reflectionGains;
+
+    // the network for the tail past the feedback start (or -1 if there isn't one), and which
+    // segment it's in. feedbackPowers is the power of the tail it took over, per IR channel, and
+    // feedbackWeights how much of that each sample of the crossfade adds to the energy, over
+    // what the IR still has there. feedbackInputs has room for the input pointers, and
+    // feedbackBuffer its output for a chunk.
+    FeedbackDelayNetwork feedbackNetwork;
+    int feedbackStartSample = -1;
+    int feedbackSegment = 0;
+    std::vector<double> feedbackPowers, feedbackWeights;
+    std::vector<const float*> feedbackInputs;
+    juce::AudioBuffer<float> feedbackBuffer;
+
+    // splitBands only: the engine for the high band, its copy of the input, its gain relative to
+    // our normalisation, and whether we've claimed its deferred stages along with ours.
+    std::unique_ptr<PartitionedConvolver> highBand;
+    juce::AudioBuffer<float> highBandBuffer;
+    float highBandGain = 1.0f;
+    bool highBandClaimed = false;
+
+    juce::SharedResourcePointer<ConvolutionWorkerPool> workerPool;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PartitionedConvolver)
+};
@@ -14,6 +14,7 @@ SilkGhostAudioProcessor::SilkGhostAudioProcessor()
 #endif
     )
     , parameters(*this, nullptr, "Parameters", createParameterLayout())
+    , irSeed((juce::uint32) juce::Random::getSystemRandom().nextInt())
     , irThreadPool(juce::ThreadPoolOptions()
          .withThreadName("IR Generation Pool")
          .withNumberOfThreads(1)
@@ -319,12 +320,29 @@ SilkGhostAudioProcessor::SilkGhostAudioProcessor()
     parameters.addParameterListener("proximity", this);
     parameters.addParameterListener("postGain", this);
     parameters.addParameterListener("wetMix", this);
-    parameters.addParameterListener("signalQuality", this);
+    parameters.addParameterListener("qualityMode", this);
     parameters.addParameterListener("presetSelection", this);
+    parameters.addParameterListener("zeroLatency", this);
+    parameters.addParameterListener("trueStereo", this);
+    parameters.addParameterListener("hybridTail", this);
+    parameters.addParameterListener("instantReverse", this);
+    parameters.addParameterListener("fixedInternalRate", this);
+    parameters.addParameterListener("multibandDecay", this);
+
+    // store the noise seed alongside the parameters so it's saved with the session.
+    parameters.state.setProperty("irSeed", (juce::int64) irSeed.load(), nullptr);
+    parameters.state.setProperty("noiseFloorDecibels", noiseFloorDecibels.load(), nullptr);
+
+    startTimerHz(requestTimerHz);
 }
 
 SilkGhostAudioProcessor::~SilkGhostAudioProcessor()
 {
+    // stop any IR job that's still running before the members it touches go away -- and make
+    // sure nothing queues another one.
+    stopTimer();
+    irThreadPool.removeAllJobs(true, 2000);
+
     parameters.removeParameterListener("decayTime", this);
     parameters.removeParameterListener("highPassFreq", this);
     parameters.removeParameterListener("lowPassFreq", this);
@@ -334,7 +352,14 @@ SilkGhostAudioProcessor::~SilkGhostAudioProcessor()
     parameters.removeParameterListener("proximity", this);
     parameters.removeParameterListener("postGain", this);
     parameters.removeParameterListener("wetMix", this);
+    parameters.removeParameterListener("qualityMode", this);
     parameters.removeParameterListener("presetSelection", this);
+    parameters.removeParameterListener("zeroLatency", this);
+    parameters.removeParameterListener("trueStereo", this);
+    parameters.removeParameterListener("hybridTail", this);
+    parameters.removeParameterListener("instantReverse", this);
+    parameters.removeParameterListener("fixedInternalRate", this);
+    parameters.removeParameterListener("multibandDecay", this);
 }
 
 const juce::String SilkGhostAudioProcessor::getName() const
@@ -371,7 +396,7 @@ bool SilkGhostAudioProcessor::isMidiEffect() const
 
 double SilkGhostAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    return tailLengthSeconds.load();
 }
 
 int SilkGhostAudioProcessor::getNumPrograms()
@@ -404,7 +429,38 @@ void SilkGhostAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBl
     spec.maximumBlockSize = samplesPerBlock;
     spec.numChannels = getTotalNumOutputChannels();
 
-    convolution.prepare(spec);
+    // everything from the pre-delay to the filters gets prepared for the wet path's rate. at a
+    // high host rate with fixedInternalRate on, that's a fraction of the host's, and the wet
+    // signal is taken down to it and brought back up either side.
+    fixedInternalRate.store(*parameters.getRawParameterValue("fixedInternalRate") > 0.5f);
+    const int factor = getInternalRateFactor(sampleRate, fixedInternalRate.load());
+    internalRateFactor.store(factor);
+
+    juce::dsp::ProcessSpec wetSpec = spec;
+    wetSpec.sampleRate = sampleRate / factor;
+    wetSpec.maximumBlockSize = (juce::uint32) (samplesPerBlock / factor + 1);
+
+    if (factor > 1)
+    {
+        wetDecimator.prepare(factor, (int) spec.numChannels);
+        wetInterpolator.prepare(factor, (int) spec.numChannels, samplesPerBlock);
+        decimatedWetBuffer.setSize((int) spec.numChannels, (int) wetSpec.maximumBlockSize);
+        wetChannels.resize(spec.numChannels);
+    }
+
+    // anything still queued or running was built for the old spec, so throw it
+    // away -- we're about to build a fresh IR synchronously below, so anything that was
+    // waiting to be queued can go as well. a job that's already running could still hand its
+    // engine (or its standby) over after the prepare below, at the old rate and block size, so
+    // both generations go first, and then we wait for it -- the builds all check in often, so
+    // it's never long.
+    ++irGeneration;
+    ++standbyGeneration;
+    impulseResponseUpdatePending.store(false);
+    standbyUpdatePending.store(false);
+    irThreadPool.removeAllJobs(true, 2000);
+
+    convolution.prepare(wetSpec);
 
     // prepare the dry/wet mixer.
     dryWetMixer.reset();
@@ -414,226 +470,596 @@ void SilkGhostAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBl
     // initialize decayTime from parameters.
     decayTime = *parameters.getRawParameterValue("decayTime");
     reverseReverb = *parameters.getRawParameterValue("reverseReverb") > 0.5f;
-    
-    float proximity = *parameters.getRawParameterValue("proximity");
     proximityParameter.store(*parameters.getRawParameterValue("proximity"));
-
-    auto impulseResponse = createReverbImpulseResponse(decayTime, sampleRate, reverseReverb, proximity);
-    
-    // set up the quality modes here. we'll cut the impulse responses by a factor of two for each
-    // level after high.
-    int qualityMode = signalQuality.load();
-    
-    if (qualityMode == 0)
-    {
-        convolution.loadImpulseResponse(
-            std::move(impulseResponse),
-            sampleRate,
-            juce::dsp::Convolution::Stereo::yes,
-            juce::dsp::Convolution::Trim::no,
-            juce::dsp::Convolution::Normalise::yes);
-    }
-    else if (qualityMode == 1)
-    {
-        auto downsampledIR = downsampleImpulseResponse(impulseResponse, 2);
-        convolution.loadImpulseResponse(
-            std::move(downsampledIR),
-            sampleRate / 2,
-            juce::dsp::Convolution::Stereo::yes,
-            juce::dsp::Convolution::Trim::no,
-            juce::dsp::Convolution::Normalise::yes);
-    }
-    else if (qualityMode == 2)
-    {
-        auto downsampledIR = downsampleImpulseResponse(impulseResponse, 4);
-        convolution.loadImpulseResponse(
-            std::move(downsampledIR),
-            sampleRate / 4,
-            juce::dsp::Convolution::Stereo::yes,
-            juce::dsp::Convolution::Trim::no,
-            juce::dsp::Convolution::Normalise::yes);
-    }
-    else if (qualityMode == 3) // garbage (ew!)
-    {
-        auto downsampledIR = downsampleImpulseResponse(impulseResponse, 6);
-        convolution.loadImpulseResponse(
-            std::move(downsampledIR),
-            sampleRate / 6,
-            juce::dsp::Convolution::Stereo::yes,
-            juce::dsp::Convolution::Trim::no,
-            juce::dsp::Convolution::Normalise::yes);
+    zeroLatency.store(*parameters.getRawParameterValue("zeroLatency") > 0.5f);
+    trueStereo.store(*parameters.getRawParameterValue("trueStereo") > 0.5f);
+    hybridTail.store(*parameters.getRawParameterValue("hybridTail") > 0.5f);
+    multiband.store(*parameters.getRawParameterValue("multibandDecay") > 0.5f);
+    instantReverse.store(*parameters.getRawParameterValue("instantReverse") > 0.5f);
+    signalQuality.store((int) *parameters.getRawParameterValue("qualityMode"));
+    convolution.setDecayTime(decayTime);
+
+    // build (or fetch from the cache) the IR for the current settings. the lower quality modes
+    // get one synthesised at the rate the engine runs at.
+    auto settings = getCurrentImpulseResponseSettings();
+    settings.sampleRate = wetSpec.sampleRate;
+    settings.maximumBlockSize = (int) wetSpec.maximumBlockSize;
+    settings.numChannels = (int) spec.numChannels;
+    settings.internalRateFactor = factor;
+
+    if (auto engine = buildEngine(settings))
+    {
+        tailLengthSeconds.store(getTailLength(*engine, settings.noiseFloorDecibels));
+        convolution.setEngine(std::move(engine));
     }
+
+    // the other orientation can wait for the background -- it's only needed once Reverse is
+    // pressed.
+    requestStandbyUpdate();
     
-    int latencySamples = convolution.getLatency();
+    int latencySamples = settings.getLatency();
+    wetLatency = latencySamples;
     dryWetMixer.setWetLatency(latencySamples);
 
+    dryHistory.setSize((int) spec.numChannels, juce::nextPowerOfTwo(maximumWetLatencyInSamples + samplesPerBlock));
+    dryHistory.clear();
+    dryHistoryPosition = 0;
+    bypassBuffer.setSize((int) spec.numChannels, samplesPerBlock);
+
+    // nothing's gone in yet, so there's nothing to ring out -- the wet path starts asleep.
+    samplesSinceInput = std::numeric_limits<juce::int64>::max() / 2;
+
     // report latency to host.
     setLatencySamples(latencySamples);
 
     // prepare filters.
-    highPassFilter.prepare(spec);
+    highPassFilter.prepare(wetSpec);
     highPassFilter.setType(juce::dsp::StateVariableTPTFilterType::highpass);
     highPassFilter.setCutoffFrequency(highPassCutoff.load());
 
-    lowPassFilter.prepare(spec);
+    lowPassFilter.prepare(wetSpec);
     lowPassFilter.setType(juce::dsp::StateVariableTPTFilterType::lowpass);
     lowPassFilter.setCutoffFrequency(lowPassCutoff.load());
 
     // prepare pre-delay line.
     preDelayLine.reset();
-    preDelayLine.prepare(spec);
-    preDelayLine.setMaximumDelayInSamples(static_cast<int>(sampleRate * 0.2f));
+    preDelayLine.prepare(wetSpec);
+    preDelayLine.setMaximumDelayInSamples(static_cast<int>(wetSpec.sampleRate * 0.2f));
 
     // prepare diffusion filters.
     diffuser1.reset();
-    diffuser1.prepare(spec);
+    diffuser1.prepare(wetSpec);
     diffuser1.setType(juce::dsp::FirstOrderTPTFilterType::allpass);
     diffuser1.setCutoffFrequency(2000.0f);
 
     diffuser2.reset();
-    diffuser2.prepare(spec);
+    diffuser2.prepare(wetSpec);
     diffuser2.setType(juce::dsp::FirstOrderTPTFilterType::allpass);
     diffuser2.setCutoffFrequency(5000.0f);
 
     // prepare modulation processor.
     modulator.reset();
-    modulator.prepare(spec);
+    modulator.prepare(wetSpec);
     modulator.setCentreDelay(10.0f);
 }
 
-// the createReverbImpulseResponse impulse response handles a ton of the logic that drives the
-// convolution engine. it'll read a signal into a buffer and generate impulse responses to simulate
-// a reverb effect.
-juce::AudioBuffer<float> SilkGhostAudioProcessor::createReverbImpulseResponse(float duration, double sampleRate, bool reverseReverb, float proximity)
+// a background job that builds a single IR. each job remembers the generation it was queued
+// with -- if a newer request shows up while we're still synthesising, we notice and throw the
+// work away instead of publishing a stale IR.
+//
+// with instant reverse on, it then builds the standby engine for the other orientation, which
+// has a generation of its own. a job can also be queued for the standby alone.
+class SilkGhostAudioProcessor::ImpulseResponseJob : public juce::ThreadPoolJob
 {
-    const int length = (int)(sampleRate * duration);
-    juce::AudioBuffer<float> impulseResponse(2, length);
-    impulseResponse.clear();
-
-    // early reflections.
-    const int numEarlyReflections = 12;
-    float earlyDelaysMs[numEarlyReflections] = {7.0f,11.0f,13.0f,17.0f,23.0f,29.0f,31.0f,37.0f,41.0f,43.0f,47.0f,53.0f};
-    float earlyGains[numEarlyReflections];
-    for (int i = 0; i < numEarlyReflections; ++i)
-        earlyGains[i] = juce::Random::getSystemRandom().nextFloat()*0.5f + 0.5f;
+public:
+    ImpulseResponseJob(SilkGhostAudioProcessor& p, const ImpulseResponseSettings& s, juce::uint32 g, juce::uint32 sg, bool standbyOnly)
+        : juce::ThreadPoolJob("IR Build"), processor(p), settings(s), generation(g), standbyGeneration(sg), buildStandbyOnly(standbyOnly)
+    {
+    }
 
-    for (int i = 0; i < numEarlyReflections; ++i)
+    JobStatus runJob() override
     {
-        int delaySamples = (int)(earlyDelaysMs[i] * sampleRate / 1000.0f);
-        if (delaySamples < length)
+        // a new standby has to wait until the audio thread has switched over to the old one,
+        // or it'd be switching to this one instead. timerCallback() holds requests back until
+        // it has, but a switch can still come in after this was queued -- if so, the request
+        // goes back to wait there, rather than keeping a thread busy checking.
+        if (buildStandbyOnly && processor.convolution.isSwitchPending())
         {
-            float g = earlyGains[i];
-            float signL = (juce::Random::getSystemRandom().nextBool() ? 1.0f : -1.0f);
-            float signR = (juce::Random::getSystemRandom().nextBool() ? 1.0f : -1.0f);
-            impulseResponse.setSample(0, delaySamples, g * signL);
-            impulseResponse.setSample(1, delaySamples, g * signR);
+            if (! shouldExit() && processor.standbyGeneration.load() == standbyGeneration)
+                processor.standbyUpdatePending.store(true);
+
+            return jobHasFinished;
+        }
+
+        if (! buildStandbyOnly)
+        {
+            std::function<bool()> isStale = [this] { return shouldExit() || processor.irGeneration.load() != generation; };
+
+            // build a whole new engine from the finished IR and hand it over to be crossfaded in.
+            // everything expensive happens here, so the audio thread only ever has to swap a
+            // pointer. only the head gets built before it goes, though -- with a long tail,
+            // that's where nearly all the time goes, and there's no need to wait for it. the
+            // rest is loaded into the engine as it plays.
+            auto engine = buildEngine(settings, isStale, true);
+
+            if (engine == nullptr || isStale())
+                return jobHasFinished;
+
+            processor.tailLengthSeconds.store(getTailLength(*engine, settings.noiseFloorDecibels));
+
+            // the spectra outlive the engine, so they can still be cached once the tail's in,
+            // whatever's happened to it in the meantime.
+            auto spectra = engine->getSpectra();
+            processor.convolution.publishAndLoadDeferredStages(std::move(engine), isStale);
+
+            if (! isStale())
+                processor.cacheSpectra(settings, std::move(spectra));
         }
+
+        if (processor.instantReverse.load())
+        {
+            std::function<bool()> isStale = [this] { return shouldExit() || processor.standbyGeneration.load() != standbyGeneration; };
+
+            auto flipped = settings;
+            flipped.reverse = ! settings.reverse;
+
+            auto standby = buildEngine(flipped, isStale);
+
+            if (standby == nullptr || isStale() || standby->getMemorySize() > getStandbyBudget())
+                return jobHasFinished;
+
+            processor.standbyTailLengthSeconds.store(getTailLength(*standby, flipped.noiseFloorDecibels));
+            processor.convolution.publishStandby(std::move(standby));
+            processor.standbyReadyGeneration.store(standbyGeneration);
+        }
+
+        return jobHasFinished;
     }
 
-    // late reverb: continuous noise with exponential decay.
-    // use a stable, smooth exponential decay: ~-60 dB at 'duration':
-    // decay envelope: exp(-6.91 * t / duration)
-    const int lateStart = (int)(0.1 * sampleRate);
-    for (int i = lateStart; i < length; ++i)
+    bool isStandbyOnly() const { return buildStandbyOnly; }
+
+private:
+    std::unique_ptr<CrossfadingConvolution::Engine> buildEngine(const ImpulseResponseSettings& s, const std::function<bool()>& isStale,
+                                                                bool deferTail = false)
     {
-        float t = (float)i / (float)sampleRate;
-        float decayEnv = std::exp(-6.91f * t / duration);
+        if (isStale())
+            return nullptr;
 
-        // generate noise: small random fluctuations for each channel.
-        float nL = (juce::Random::getSystemRandom().nextFloat()*2.0f - 1.0f) * 0.5f;
-        float nR = (juce::Random::getSystemRandom().nextFloat()*2.0f - 1.0f) * 0.5f;
+        return processor.buildEngine(s, isStale, deferTail);
+    }
 
-        impulseResponse.setSample(0, i, nL * decayEnv);
-        impulseResponse.setSample(1, i, nR * decayEnv);
+    static size_t getStandbyBudget()
+    {
+        const auto eighthOfMemory = (size_t) juce::SystemStats::getMemorySizeInMegabytes() * 1024 * 1024 / 8;
+        return juce::jmin(maximumStandbySizeInBytes, eighthOfMemory);
     }
 
-    // gentle amplitude modulation instead of re-indexing:
-    // we'll vary amplitude slightly with a slow sine to avoid static sound.
-    float modDepth = 0.05f;   // 5% amplitude variation.
-    float modRate = 0.1f;     // slow modulation rate, 0.1 Hz.
-    for (int c = 0; c < impulseResponse.getNumChannels(); ++c)
+    SilkGhostAudioProcessor& processor;
+    const ImpulseResponseSettings settings;
+    const juce::uint32 generation;
+    const juce::uint32 standbyGeneration;
+    const bool buildStandbyOnly;
+};
+
+SilkGhostAudioProcessor::ImpulseResponseSettings SilkGhostAudioProcessor::getCurrentImpulseResponseSettings() const
+{
+    ImpulseResponseSettings settings;
+    settings.decayTime = *parameters.getRawParameterValue("decayTime");
+    settings.reverse = *parameters.getRawParameterValue("reverseReverb") > 0.5f;
+    settings.internalRateFactor = internalRateFactor.load();
+    settings.sampleRate = getSampleRate() / settings.internalRateFactor;
+    settings.qualityMode = signalQuality.load();
+    settings.seed = irSeed.load();
+    settings.maximumBlockSize = getBlockSize() / settings.internalRateFactor + 1;
+    settings.numChannels = getTotalNumOutputChannels();
+    settings.zeroLatency = zeroLatency.load();
+    settings.multiband = multiband.load();
+    settings.hybridTail = hybridTail.load();
+    settings.noiseFloorDecibels = noiseFloorDecibels.load();
+
+    // four paths only make sense with a stereo output -- anything else would just throw the
+    // cross paths away.
+    settings.trueStereo = trueStereo.load() && settings.numChannels == 2;
+    return settings;
+}
+
+PartitionedConvolver::Scheme SilkGhostAudioProcessor::ImpulseResponseSettings::getConvolutionScheme() const
+{
+    PartitionedConvolver::Scheme scheme;
+    scheme.zeroLatency = zeroLatency;
+    scheme.decimation = getDecimation();
+    scheme.splitBands = splitsBands();
+    return scheme;
+}
+
+SilkGhostAudioProcessor::ImpulseResponseSettings SilkGhostAudioProcessor::ImpulseResponseSettings::getHighBandSettings() const
+{
+    auto highBand = *this;
+    highBand.qualityMode = 0;
+    highBand.multiband = false;
+    return highBand;
+}
+
+int SilkGhostAudioProcessor::ImpulseResponseSettings::getDecimation() const
+{
+    // the resampling filters have latency of their own, so zero-latency mode always runs at the
+    // full rate, whatever the quality.
+    static constexpr int decimationFactors[] = { 1, 2, 4, 6 };
+    if (zeroLatency)
+        return 1;
+
+    const int factor = decimationFactors[juce::jlimit(0, 3, qualityMode)];
+    return splitsBands() ? juce::jmax(factor, 4) : factor;
+}
+
+int SilkGhostAudioProcessor::ImpulseResponseSettings::getLatency() const
+{
+    return getConvolutionScheme().getLatency() * internalRateFactor + PolyphaseResampling::getLatency(internalRateFactor);
+}
+
+int SilkGhostAudioProcessor::getInternalRateFactor(double hostSampleRate, bool useFixedRate)
+{
+    // whole-number factors only, so the filters stay simple polyphase ones: 88.2 and 96kHz are
+    // halved, 176.4 and 192kHz quartered, and so on. the usual rates all land on 44.1 or 48kHz,
+    // and nothing ends up below 44.1kHz.
+    if (! useFixedRate)
+        return 1;
+
+    return juce::jmax(1, (int) std::floor(hostSampleRate / 44100.0 + 1.0e-6));
+}
+
+int SilkGhostAudioProcessor::getWetLatency(int convolutionLatency) const
+{
+    const int factor = internalRateFactor.load();
+    return convolutionLatency * factor + PolyphaseResampling::getLatency(factor);
+}
+
+PartitionedConvolver::Layout SilkGhostAudioProcessor::ImpulseResponseSettings::getConvolutionLayout(const PreparedImpulseResponse& impulseResponse,
+                                                                                                    bool highBand) const
+{
+    PartitionedConvolver::Layout layout;
+    layout.decayStart = decaysInConvolution() ? lateStartSeconds : -1.0;
+    layout.lateStart = reverse ? decayTime - lateStartSeconds : lateStartSeconds;
+    layout.lateFirst = reverse;
+
+    // this goes by the decay time we're building for. the engine stops at the -60dB point
+    // anyway, so there's room for it to grow by a good half again before we run out of IR.
+    if (decaysInConvolution())
     {
-        auto* data = impulseResponse.getWritePointer(c);
-        for (int i = lateStart; i < length; ++i)
-        {
-            float t = (float)i / (float)sampleRate;
-            float mod = 1.0f + modDepth * std::sin(2.0f * juce::MathConstants<float>::pi * modRate * t);
-            data[i] *= mod;
-        }
+        const auto rate = impulseResponse.sampleRate;
+        const auto decay = highBand ? decayTime * getConvolutionScheme().highBandDecayRatio : decayTime;
+        const auto length = ImpulseResponseSynthesis::findNoiseFloorLength(impulseResponse.buffer, rate, noiseFloorDecibels,
+                                                                           (int) (lateStartSeconds * rate), decay);
+        layout.end = length / rate;
     }
 
-    // adjust the proximity: early vs. late energy.
-    proximity = juce::jlimit(0.0f, 1.0f, proximity / 100.0f);
-    float earlyGain = juce::jmap(proximity, 1.0f, 0.0f);
-    float lateGain = juce::jmap(proximity, 0.5f, 1.0f);
-    for (int c = 0; c < impulseResponse.getNumChannels(); ++c)
+    // the high band's IR is left without them as well -- the tap delay covers the full band.
+    if (reflectionsInTapDelay() && ! highBand)
+        layout.reflections = createEarlyReflections(seed, trueStereo);
+
+    // the high band's short tail is left as it is: it dies away long before the network would
+    // start paying for itself.
+    if (usesFeedbackTail() && ! highBand)
+        layout.feedbackStart = feedbackStartSeconds;
+
+    return layout;
+}
+
+ImpulseResponseCache::SpectraKey SilkGhostAudioProcessor::ImpulseResponseSettings::getSpectraKey() const
+{
+    return { decayTime, reverse, sampleRate, seed, trueStereo, getDecimation(), zeroLatency, splitsBands(), usesFeedbackTail(),
+             noiseFloorDecibels };
+}
+
+std::shared_ptr<const PreparedImpulseResponse> SilkGhostAudioProcessor::prepareImpulseResponse(const ImpulseResponseSettings& settings,
+                                                                                               const std::function<bool()>& shouldCancel)
+{
+    // an IR without its decay is the same for every decay time, so those all share one entry
+    // (decay time zero, which the parameter can't be).
+    // the IR is synthesised at the rate the engine runs at, so it's keyed on that rate rather than
+    // on the quality mode -- which would give zero-latency mode a copy of its own for nothing.
+    const bool applyDecay = ! settings.decaysInConvolution();
+    const double impulseResponseRate = settings.sampleRate / settings.getDecimation();
+    const ImpulseResponseCache::Key key(applyDecay ? settings.decayTime : 0.0f, settings.reverse,
+                                        impulseResponseRate, 0, settings.seed, settings.trueStereo, settings.noiseFloorDecibels);
+
+    if (auto cached = irCache.get(key))
+        return cached;
+
+    if (auto fromDisk = irDiskCache->load(key))
     {
-        auto* data = impulseResponse.getWritePointer(c);
-        for (int i = 0; i < length; ++i)
-        {
-            if (i < lateStart)
-                data[i] *= earlyGain;
-            else
-                data[i] *= lateGain;
-        }
+        irCache.insert(key, fromDisk);
+        return fromDisk;
     }
 
-    if (reverseReverb)
+    auto impulseResponse = createReverbImpulseResponse(applyDecay ? settings.decayTime : maximumDecayTime, impulseResponseRate,
+                                                       settings.reverse, settings.seed, settings.trueStereo,
+                                                       applyDecay, ! settings.reflectionsInTapDelay(), settings.noiseFloorDecibels,
+                                                       shouldCancel);
+    if (impulseResponse.getNumSamples() == 0)
+        return nullptr;
+
+    auto prepared = std::make_shared<PreparedImpulseResponse>();
+    prepared->buffer = std::move(impulseResponse);
+    prepared->sampleRate = impulseResponseRate;
+
+    irCache.insert(key, prepared);
+    irDiskCache->store(key, *prepared);
+    return prepared;
+}
+
+std::unique_ptr<CrossfadingConvolution::Engine> SilkGhostAudioProcessor::buildEngine(const ImpulseResponseSettings& settings,
+                                                                                     const std::function<bool()>& shouldCancel,
+                                                                                     bool deferTail)
+{
+    auto isCancelled = [&shouldCancel] { return shouldCancel != nullptr && shouldCancel(); };
+
+    auto prepared = prepareImpulseResponse(settings, shouldCancel);
+
+    if (prepared == nullptr || isCancelled())
+        return nullptr;
+
+    // with the bands split, the high band wants the same IR at the full rate -- the one the High
+    // quality mode uses, so there's a fair chance it's cached already.
+    std::shared_ptr<const PreparedImpulseResponse> highBand;
+    if (settings.splitsBands())
     {
-        for (int channel = 0; channel < impulseResponse.getNumChannels(); ++channel)
-        {
-            auto* data = impulseResponse.getWritePointer(channel);
-            std::reverse(data, data + length);
-        }
+        highBand = prepareImpulseResponse(settings.getHighBandSettings(), shouldCancel);
+
+        if (highBand == nullptr || isCancelled())
+            return nullptr;
+    }
+
+    // the engine only reads the IRs while it works out the partition spectra, so there's no
+    // need to copy them out of the cache. if an engine's been built this way before, the spectra
+    // are most likely cached as well, and then there's nothing to transform.
+    const juce::dsp::ProcessSpec spec { settings.sampleRate, (juce::uint32) settings.maximumBlockSize, (juce::uint32) settings.numChannels };
+    auto layout = settings.getConvolutionLayout(*prepared);
+    layout.deferredStart = deferTail ? immediateLoadSeconds : -1.0;
+
+    auto spectra = irCache.getSpectra(settings.getSpectraKey());
+
+    auto engine = CrossfadingConvolution::createEngine(prepared->buffer, prepared->sampleRate, spec, settings.getConvolutionScheme(),
+                                                       layout, spectra);
+
+    if (highBand != nullptr)
+    {
+        auto highBandLayout = settings.getConvolutionLayout(*highBand, true);
+        highBandLayout.deferredStart = layout.deferredStart;
+        engine->loadHighBandImpulseResponse(highBand->buffer, highBand->sampleRate, highBandLayout, spectra);
+    }
+
+    // with a deferred tail, they aren't finished yet -- the job caches them once they are.
+    if (spectra == nullptr)
+        cacheSpectra(settings, engine->getSpectra());
+
+    return engine;
+}
+
+void SilkGhostAudioProcessor::cacheSpectra(const ImpulseResponseSettings& settings,
+                                           std::shared_ptr<const CrossfadingConvolution::Engine::Spectra> spectra)
+{
+    if (spectra != nullptr && spectra->isComplete())
+        irCache.insertSpectra(settings.getSpectraKey(), std::move(spectra));
+}
+
+double SilkGhostAudioProcessor::getTailLength(const CrossfadingConvolution::Engine& engine, float floorDecibels)
+{
+    if (engine.hasFeedbackTail())
+        return maximumDecayTime * -floorDecibels / 60.0;
+
+    return engine.getImpulseResponseLengthInSeconds();
+}
+
+void SilkGhostAudioProcessor::requestImpulseResponseUpdate()
+{
+    // bumping the generation marks every job already in flight as stale -- it'll check in and
+    // bail on its own. this builds for the current orientation, so a switch to the standby that
+    // hasn't happened yet is out of date too. none of this locks or allocates.
+    ++irGeneration;
+    ++standbyGeneration;
+    convolution.cancelSwitch();
+    impulseResponseUpdatePending.store(true);
+}
+
+void SilkGhostAudioProcessor::startImpulseResponseJob()
+{
+    auto settings = getCurrentImpulseResponseSettings();
+
+    // a preset load or a restored state can move the decay time without telling
+    // parameterChanged, so pass it on here too.
+    convolution.setDecayTime(settings.decayTime);
+
+    if (settings.sampleRate <= 0.0 || settings.maximumBlockSize <= 0)
+        return;
+
+    // the quality mode, zero-latency mode and the band split all change the latency. tell the
+    // host straight away -- most will re-prepare us, but if one doesn't, the new engine still
+    // gets crossfaded in and processBlock moves the dry delay over to match. for anything else
+    // it's the same as before, and the host doesn't hear about it.
+    setLatencySamples(settings.getLatency());
 
-        // analyze the first 100ms of reversed IR.
-        int checkSamples = (int)(0.1 * sampleRate); // set the 100ms here.
-        checkSamples = juce::jmin(checkSamples, length);
+    // this builds a new standby too, unless there's not meant to be one at all.
+    if (! instantReverse.load())
+        convolution.discardStandby();
 
-        float startMax = 0.0f;
-        for (int c = 0; c < impulseResponse.getNumChannels(); ++c)
+    // pull anything that hasn't started yet out of the queue and ask the running job to exit,
+    // without waiting for it.
+    irThreadPool.removeAllJobs(true, 0);
+    irThreadPool.addJob(new ImpulseResponseJob(*this, settings, irGeneration.load(), standbyGeneration.load(), false), true);
+}
+
+void SilkGhostAudioProcessor::timerCallback()
+{
+    // a re-prepare builds a fresh engine, and throws away any request that was waiting, so it
+    // goes first. the host is kept out of processBlock while it happens.
+    if (internalRateChangePending.exchange(false) && getSampleRate() > 0.0
+        && getInternalRateFactor(getSampleRate(), fixedInternalRate.load()) != internalRateFactor.load())
+    {
+        suspendProcessing(true);
+        prepareToPlay(getSampleRate(), getBlockSize());
+        suspendProcessing(false);
+    }
+
+    // a full build makes a new standby as well, so it takes care of both. the flag's cleared
+    // before the job takes the standby generation, so a request in between isn't lost.
+    if (impulseResponseUpdatePending.exchange(false))
+    {
+        standbyUpdatePending.store(false);
+        startImpulseResponseJob();
+    }
+    else if (standbyUpdatePending.load() && ! convolution.isSwitchPending())
+    {
+        // (a new standby has to wait until the audio thread has switched over to the old one,
+        // or it'd be switching to this one instead -- until then, the request just waits here.)
+        standbyUpdatePending.store(false);
+        startStandbyJob();
+    }
+}
+
+void SilkGhostAudioProcessor::requestStandbyUpdate()
+{
+    // whatever's on standby now is out of date either way. as with a full request, this can be
+    // the audio thread, so the rest is left for timerCallback().
+    ++standbyGeneration;
+    standbyUpdatePending.store(true);
+}
+
+void SilkGhostAudioProcessor::startStandbyJob()
+{
+    auto settings = getCurrentImpulseResponseSettings();
+    if (! instantReverse.load() || settings.sampleRate <= 0.0 || settings.maximumBlockSize <= 0)
+    {
+        convolution.discardStandby();
+        return;
+    }
+
+    // only standby jobs that haven't started yet come out of the queue -- a full rebuild could
+    // be in there too. one that's already running will see it's stale and bail.
+    struct StandbyJobs : public juce::ThreadPool::JobSelector
+    {
+        bool isJobSuitable(juce::ThreadPoolJob* job) override
         {
-            auto* d = impulseResponse.getReadPointer(c);
-            for (int i = 0; i < checkSamples; ++i)
-                startMax = juce::jmax(startMax, std::abs(d[i]));
+            auto* irJob = dynamic_cast<ImpulseResponseJob*>(job);
+            return irJob != nullptr && irJob->isStandbyOnly();
         }
+    };
+
+    StandbyJobs standbyJobs;
+    irThreadPool.removeAllJobs(false, 0, &standbyJobs);
+    irThreadPool.addJob(new ImpulseResponseJob(*this, settings, irGeneration.load(), standbyGeneration.load(), true), true);
+}
+
+// the createReverbImpulseResponse impulse response handles a ton of the logic that drives the
+// convolution engine. it'll read a signal into a buffer and generate impulse responses to simulate
+// a reverb effect. if shouldCancel is given and returns true part-way through, we stop early and
+// hand back an empty buffer.
+//
+// normally we build a stereo IR (L to L, R to R). for true stereo we build four channels instead
+// -- LL, LR, RL and RR -- each with its own reflection signs and its own noise seed, so the
+// paths are decorrelated from each other and the cross paths widen the image rather than just
+// collapsing it towards mono.
+//
+// without applyDecay, the tail is left at full level for the whole duration, ready for the
+// convolution engine to decay it (see ImpulseResponseSettings::decaysInConvolution). in the same
+// way, without includeEarlyReflections, the reflections are left for the engine's tap delay.
+juce::AudioBuffer<float> SilkGhostAudioProcessor::createReverbImpulseResponse(float duration, double sampleRate, bool reverseReverb,
+                                                                              juce::uint32 seed, bool trueStereo, bool applyDecay,
+                                                                              bool includeEarlyReflections, float floorDecibels,
+                                                                              const std::function<bool()>& shouldCancel)
+{
+    auto cancelled = [&shouldCancel] { return shouldCancel != nullptr && shouldCancel(); };
+
+    const int length = (int)(sampleRate * duration);
+    const int numPaths = trueStereo ? 4 : 2;
+    juce::AudioBuffer<float> impulseResponse(numPaths, length);
+    impulseResponse.clear();
+
+    // when reversing, we write every sample straight into its mirrored position rather than
+    // building the IR forwards and flipping it afterwards.
+    auto position = [length, reverseReverb](int i) { return reverseReverb ? length - 1 - i : i; };
 
-        // hacky, but if start is too quiet, boost the entire IR so that startMax ~ 0.9f!
-        if (startMax < 0.9f && startMax > 0.0f)
+    // early reflections, if they're going in the IR.
+    float maxAmp = 0.0f;
+    if (includeEarlyReflections)
+    {
+        const auto reflections = createEarlyReflections(seed, trueStereo);
+        for (int i = 0; i < reflections.getNumTaps(); ++i)
         {
-            float boost = 0.9f / startMax;
-            impulseResponse.applyGain(boost);
+            int delaySamples = juce::roundToInt(reflections.times[(size_t) i] * sampleRate);
+            if (delaySamples < length)
+            {
+                for (int path = 0; path < numPaths; ++path)
+                    impulseResponse.setSample(path, position(delaySamples), reflections.gains.getSample(path, i));
+
+                maxAmp = juce::jmax(maxAmp, std::abs(reflections.gains.getSample(0, i)));
+            }
         }
     }
 
-    // finally, normalize the IR if needed.
-    float maxAmp = 0.0f;
-    for (int c = 0; c < impulseResponse.getNumChannels(); ++c)
-        maxAmp = juce::jmax(maxAmp, impulseResponse.getMagnitude(c, 0, length));
+    // late reverb: continuous noise with exponential decay (~-60 dB at 'duration') and a gentle
+    // 0.1 Hz amplitude modulation so it doesn't sound static. the kernel does all of that, plus
+    // the late gain and the peak measurement, in one go -- split into slices across every core.
+    const int lateStart = (int)(lateStartSeconds * sampleRate);
+
+    ImpulseResponseSynthesis::LateTailParameters tail;
+    tail.sampleRate = sampleRate;
+    tail.decayTime = applyDecay ? duration : 0.0f;
 
-    if (maxAmp > 0.0f)
+    auto latePeak = ImpulseResponseSynthesis::renderLateTailParallel(*synthesisWorkers, impulseResponse, lateStart,
+                                                                     tail, seed, reverseReverb, shouldCancel);
+    if (! latePeak.has_value() || cancelled())
+        return {};
+
+    maxAmp = juce::jmax(maxAmp, *latePeak);
+
+    // the reverse mode used to boost the whole IR so the first 100ms peaked around 0.9, but
+    // that's a flat gain -- the normalisation below undoes it exactly, so we skip it.
+
+    // finally, normalize the IR if needed. we already know the peak from the passes above. an IR
+    // without its reflections is left at the level it was made at, as the tap delay's are at
+    // that level too -- the engine normalises the two of them together.
+    if (includeEarlyReflections && maxAmp > 0.0f)
         impulseResponse.applyGain(1.0f / maxAmp);
 
+    // and cut it off once it's dropped below the noise floor for good. a baked decay is only
+    // down 60dB by the end, so this is mostly for IRs that ring on past it -- a tail without a
+    // decay never gets there at all, and is cut down to size by the engine instead.
+    const int trimmedLength = ImpulseResponseSynthesis::findNoiseFloorLength(impulseResponse, sampleRate, floorDecibels);
+    if (trimmedLength < length)
+        impulseResponse.setSize(numPaths, trimmedLength, true);
+
     return impulseResponse;
 }
 
-juce::AudioBuffer<float> SilkGhostAudioProcessor::downsampleImpulseResponse(const juce::AudioBuffer<float>& impulseResponse, int factor)
+// the early reflections: a dozen of them between 7 and 53ms, each with its own level, and its
+// own sign on every path. we use our own seeded generator here (the system one isn't safe to
+// share between threads), so the same settings always give the same reflections.
+SparseTapDelay::Taps SilkGhostAudioProcessor::createEarlyReflections(juce::uint32 seed, bool trueStereo)
 {
-    int numChannels = impulseResponse.getNumChannels();
-    int numSamples = impulseResponse.getNumSamples() / factor;
-    juce::AudioBuffer<float> downsampledIR(numChannels, numSamples);
+    juce::Random random((juce::int64) seed);
+    const int numEarlyReflections = 12;
+    float earlyDelaysMs[numEarlyReflections] = {7.0f,11.0f,13.0f,17.0f,23.0f,29.0f,31.0f,37.0f,41.0f,43.0f,47.0f,53.0f};
+    float earlyGains[numEarlyReflections];
+    for (int i = 0; i < numEarlyReflections; ++i)
+        earlyGains[i] = random.nextFloat()*0.5f + 0.5f;
+
+    const int numPaths = trueStereo ? 4 : 2;
+    SparseTapDelay::Taps reflections;
+    reflections.gains.setSize(numPaths, numEarlyReflections);
 
-    for (int channel = 0; channel < numChannels; ++channel)
+    for (int i = 0; i < numEarlyReflections; ++i)
     {
-        auto* readPtr = impulseResponse.getReadPointer(channel);
-        auto* writePtr = downsampledIR.getWritePointer(channel);
-        for (int i = 0; i < numSamples; ++i)
+        reflections.times.push_back(earlyDelaysMs[i] / 1000.0);
+
+        for (int path = 0; path < numPaths; ++path)
         {
-            writePtr[i] = readPtr[i * factor];
+            float sign = (random.nextBool() ? 1.0f : -1.0f);
+            reflections.gains.setSample(path, i, earlyGains[i] * sign);
         }
     }
 
-    return downsampledIR;
+    return reflections;
 }
 
 void SilkGhostAudioProcessor::loadPreset(int presetIndex)
@@ -670,20 +1096,8 @@ void SilkGhostAudioProcessor::loadPreset(int presetIndex)
     isLoadingPreset.store(false);
 
     // force an IR update once to rebuild the parameters properly.
-    double sr = getSampleRate();
-    if (sr > 0.0)
-    {
-        float irDuration = *parameters.getRawParameterValue("decayTime");
-        bool reverse = (*parameters.getRawParameterValue("reverseReverb") > 0.5f);
-        float proximityVal = *parameters.getRawParameterValue("proximity");
-
-        auto newIR = createReverbImpulseResponse(irDuration, sr, reverse, proximityVal);
-        {
-            std::lock_guard<std::mutex> lock(irMutex);
-            newImpulseResponseBuffer = std::move(newIR);
-            irNeedsUpdate.store(true);
-        }
-    }
+    proximityParameter.store(*parameters.getRawParameterValue("proximity"));
+    requestImpulseResponseUpdate();
 
     // trigger UI and host updates.
     updateHostDisplay();
@@ -782,6 +1196,53 @@ juce::AudioProcessorValueTreeState::ParameterLayout SilkGhostAudioProcessor::cre
         "postGain", "Post Gain",
         juce::NormalisableRange<float>(-36.0f, 36.0f, 0.1f), 0.0f));
 
+    // for playing live through the reverb -- swaps the convolution's first
+    // partition for a direct FIR so the wet path has no latency. it changes
+    // the latency we report, so it's not something to automate.
+    params.emplace_back(std::make_unique<juce::AudioParameterBool>(
+        "zeroLatency",
+        "Zero Latency",
+        false,
+        juce::AudioParameterBoolAttributes().withAutomatable(false)));
+
+    // convolve with four IR paths (LL, LR, RL, RR) instead of two, so each
+    // side of the input spills into both sides of the reverb.
+    params.emplace_back(std::make_unique<juce::AudioParameterBool>(
+        "trueStereo",
+        "True Stereo",
+        false));
+
+    // past the first few hundred ms, leave the tail to a feedback delay network
+    // rather than convolving it, so a long decay costs no more than a short one.
+    params.emplace_back(std::make_unique<juce::AudioParameterBool>(
+        "hybridTail",
+        "Hybrid Tail",
+        false));
+
+    // keep an engine for the other orientation built and waiting, so Reverse
+    // switches over straight away. it doubles what the IR takes up in memory.
+    params.emplace_back(std::make_unique<juce::AudioParameterBool>(
+        "instantReverse",
+        "Instant Reverse",
+        false,
+        juce::AudioParameterBoolAttributes().withAutomatable(false)));
+
+    // at 88.2kHz and up, run the wet path at 44.1 or 48kHz instead, so a high-rate session
+    // costs about what a normal one does. it changes the latency we report.
+    params.emplace_back(std::make_unique<juce::AudioParameterBool>(
+        "fixedInternalRate",
+        "Fixed Internal Rate",
+        false,
+        juce::AudioParameterBoolAttributes().withAutomatable(false)));
+
+    // let the highs die away faster than the lows, by running them through an engine of their
+    // own. it decimates the low band, so it changes the latency we report.
+    params.emplace_back(std::make_unique<juce::AudioParameterBool>(
+        "multibandDecay",
+        "Multiband Decay",
+        false,
+        juce::AudioParameterBoolAttributes().withAutomatable(false)));
+
     return { params.begin(), params.end() };
 }
 
@@ -789,6 +1250,7 @@ void SilkGhostAudioProcessor::releaseResources()
 {
     // reset convolution and filters so we don't hog CPU resources.
     convolution.reset();
+    convolution.collectGarbage();
     highPassFilter.reset();
     lowPassFilter.reset();
     preDelayLine.reset();
@@ -822,28 +1284,21 @@ bool SilkGhostAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts
 
 void SilkGhostAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
-    juce::ScopedNoDenormals noDenormals;
-
-    // update impulse response if needed.
-    if (irNeedsUpdate.load())
-    {
-        juce::AudioBuffer<float> irToLoad;
+    juce::ignoreUnused(midiMessages);
+    processAudio(buffer, false);
+}
 
-        // lock mutex to safely access the new IR buffer!
-        {
-            std::lock_guard<std::mutex> lock(irMutex);
-            irToLoad = newImpulseResponseBuffer;
-            irNeedsUpdate.store(false);
-        }
+void SilkGhostAudioProcessor::processBlockBypassed(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    // (JUCE's own version just passes the input straight through, which doesn't line up with
+    // our latency.)
+    juce::ignoreUnused(midiMessages);
+    processAudio(buffer, true);
+}
 
-        // load the new impulse response into the convolution processor.
-        convolution.loadImpulseResponse(
-            std::move(irToLoad),
-            getSampleRate(),
-            juce::dsp::Convolution::Stereo::yes,
-            juce::dsp::Convolution::Trim::no,
-            juce::dsp::Convolution::Normalise::yes);
-    }
+void SilkGhostAudioProcessor::processAudio(juce::AudioBuffer<float>& buffer, bool bypassed)
+{
+    juce::ScopedNoDenormals noDenormals;
 
     // get the wet mix parameter.
     float wetMix = *parameters.getRawParameterValue("wetMix") / 100.0f;
@@ -855,12 +1310,131 @@ void SilkGhostAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juc
     // create an AudioBlock from buffer.
     juce::dsp::AudioBlock<float> block(buffer);
 
+    // keep the dry delay matched to whichever engine is running.
+    if (const int latency = getWetLatency(convolution.getLatency()); latency != wetLatency)
+    {
+        wetLatency = latency;
+        dryWetMixer.setWetLatency((float) latency);
+    }
+
+    const int numSamples = buffer.getNumSamples();
+    const int numDryChannels = juce::jmin(buffer.getNumChannels(), dryHistory.getNumChannels());
+    const int dryHistorySize = dryHistory.getNumSamples();
+
+    // keep our own copy of the dry signal, for whenever we're bypassed.
+    {
+        const auto start = (int) (dryHistoryPosition & (dryHistorySize - 1));
+        const int firstRun = juce::jmin(numSamples, dryHistorySize - start);
+
+        for (int channel = 0; channel < numDryChannels; ++channel)
+        {
+            juce::FloatVectorOperations::copy(dryHistory.getWritePointer(channel) + start, buffer.getReadPointer(channel), firstRun);
+            juce::FloatVectorOperations::copy(dryHistory.getWritePointer(channel), buffer.getReadPointer(channel) + firstRun, numSamples - firstRun);
+        }
+
+        dryHistoryPosition += numSamples;
+    }
+
+    if (bypassed || isInputSilent(buffer))
+        samplesSinceInput += numSamples;
+    else
+        samplesSinceInput = 0;
+
     // save dry input signal.
     dryWetMixer.pushDrySamples(block);
 
+    // bypassed, the reverb only gets silence, so all it does is ring out.
+    if (bypassed)
+        block.clear();
+
+    // run the wet path, at the host rate or at the internal one -- unless it's rung out, in which
+    // case it's silent until the input comes back, and there's no need to run any of it. the
+    // convolution still takes any engine it's been handed, so builds and switches don't wait
+    // for the input to come back.
+    if (samplesSinceInput > getRingOutSamples())
+    {
+        block.clear();
+        convolution.processSilence();
+    }
+    else if (const int factor = internalRateFactor.load(); factor > 1)
+    {
+        const int numChannels = (int) block.getNumChannels();
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            wetChannels[(size_t) channel] = block.getChannelPointer((size_t) channel);
+
+        const int numDecimated = wetDecimator.process(wetChannels.data(), decimatedWetBuffer.getArrayOfWritePointers(),
+                                                      numChannels, numSamples);
+
+        // (a block shorter than the factor can come out empty.)
+        if (numDecimated > 0)
+        {
+            juce::dsp::AudioBlock<float> wetBlock(decimatedWetBuffer.getArrayOfWritePointers(), (size_t) numChannels, (size_t) numDecimated);
+            processWetPath(wetBlock);
+        }
+
+        wetInterpolator.process(decimatedWetBuffer.getArrayOfReadPointers(), numDecimated, wetChannels.data(), numChannels, numSamples);
+    }
+    else
+    {
+        processWetPath(block);
+    }
+
+    // finally, mix dry and wet signals.
+    if (! bypassed)
+    {
+        dryWetMixer.mixWetSamples(block);
+        return;
+    }
+
+    // bypassed, the mixer still gets its block, to keep it in step for when we come back, but
+    // what goes out is the dry at full level, delayed by our latency, with the tail on top at the
+    // level the mixer would give it (its balanced rule).
+    juce::dsp::AudioBlock<float> bypassBlock(bypassBuffer.getArrayOfWritePointers(), (size_t) bypassBuffer.getNumChannels(), (size_t) numSamples);
+    bypassBlock.copyFrom(block);
+    dryWetMixer.mixWetSamples(bypassBlock);
+
+    block.multiplyBy(2.0f * juce::jmin(0.5f, wetMix));
+
+    const auto start = (int) ((dryHistoryPosition - numSamples - wetLatency) & (dryHistorySize - 1));
+    const int firstRun = juce::jmin(numSamples, dryHistorySize - start);
+
+    for (int channel = 0; channel < numDryChannels; ++channel)
+    {
+        juce::FloatVectorOperations::add(buffer.getWritePointer(channel), dryHistory.getReadPointer(channel) + start, firstRun);
+        juce::FloatVectorOperations::add(buffer.getWritePointer(channel) + firstRun, dryHistory.getReadPointer(channel), numSamples - firstRun);
+    }
+}
+
+bool SilkGhostAudioProcessor::isInputSilent(const juce::AudioBuffer<float>& buffer) const
+{
+    const auto threshold = juce::Decibels::decibelsToGain(silenceThresholdDecibels);
+
+    for (int channel = 0; channel < juce::jmin(getTotalNumInputChannels(), buffer.getNumChannels()); ++channel)
+        if (buffer.getMagnitude(channel, 0, buffer.getNumSamples()) > threshold)
+            return false;
+
+    return true;
+}
+
+juce::int64 SilkGhostAudioProcessor::getRingOutSamples() const
+{
+    // the engine's decay carries on from the last of the input until it's down at the noise
+    // floor, where a forward IR gets cut off anyway -- unless the IR it's running stops sooner,
+    // as a reverse one (or one cut off for a shorter decay) does. on top of that go the
+    // pre-delay, the short tails of the chorus and filters, and our latency.
+    const auto decay = (double) *parameters.getRawParameterValue("decayTime");
+    const auto tail = juce::jmin(tailLengthSeconds.load(), decay * -noiseFloorDecibels.load() / 60.0);
+    const auto preDelay = *parameters.getRawParameterValue("preDelay") / 1000.0;
+
+    return (juce::int64) ((preDelay + tail + ringOutMarginSeconds) * getSampleRate()) + wetLatency;
+}
+
+void SilkGhostAudioProcessor::processWetPath(juce::dsp::AudioBlock<float>& block)
+{
     // get pre-delay in samples.
     float preDelayMs = *parameters.getRawParameterValue("preDelay");
-    float preDelaySamples = (preDelayMs / 1000.0f) * getSampleRate();
+    float preDelaySamples = (preDelayMs / 1000.0f) * (float) (getSampleRate() / internalRateFactor.load());
     preDelayLine.setDelay(preDelaySamples);
 
     // process pre-delay.
@@ -872,7 +1446,13 @@ void SilkGhostAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juc
     diffuser1.process(diffusionContext);
     diffuser2.process(diffusionContext);
 
-    // process convolution (wet signal).
+    // adjust the proximity: early vs. late energy. the engine keeps the two parts of the IR
+    // apart and smooths these gains itself, so they can move every block.
+    const float proximity = juce::jlimit(0.0f, 1.0f, proximityParameter.load() / 100.0f);
+    convolution.setEarlyLateGains(juce::jmap(proximity, 1.0f, 0.0f), juce::jmap(proximity, 0.5f, 1.0f));
+
+    // process convolution (wet signal). any newly built IR is picked up and
+    // crossfaded in here.
     juce::dsp::ProcessContextReplacing<float> convolutionContext(block);
     convolution.process(convolutionContext);
 
@@ -894,35 +1474,53 @@ void SilkGhostAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juc
     float internalBoost = juce::Decibels::decibelsToGain(12.0f);
     float gain = juce::Decibels::decibelsToGain(postGain.load());
     block.multiplyBy(gain * internalBoost);
-
-    // finally, mix dry and wet signals.
-    dryWetMixer.mixWetSamples(block);
 }
 
 void SilkGhostAudioProcessor::parameterChanged(const juce::String& parameterID, float newValue)
 {
     if (isLoadingPreset.load())
             return;
-    if (parameterID == "decayTime" || parameterID == "reverseReverb" || parameterID == "proximity")
+    if (parameterID == "decayTime")
     {
-        double sampleRate = getSampleRate();
-        if (sampleRate > 0.0)
+        // in the forward mode this is usually all it takes -- the engine rescales the tail it
+        // already has. only a reverse IR has to be built again, or a forward one that was cut
+        // off at the noise floor before the new decay time is up.
+        convolution.setDecayTime(newValue);
+
+        // (a few ms over is just rounding -- the full-length IR can come up that little bit short
+        // once it's been resampled.)
+        const bool outgrewTail = newValue > tailLengthSeconds.load() + 0.01;
+
+        // otherwise, the standby engine's reversed when we're not, so it's the one that needs
+        // rebuilding.
+        if (*parameters.getRawParameterValue("reverseReverb") > 0.5f || outgrewTail)
+            requestImpulseResponseUpdate();
+        else if (instantReverse.load())
+            requestStandbyUpdate();
+    }
+    else if (parameterID == "reverseReverb")
+    {
+        // if the other orientation is already built and waiting, switching over is just a
+        // crossfade, and the one we're leaving gets built again as the new standby.
+        // otherwise, don't build the IR here -- this can be the message thread (or worse, the
+        // audio thread under automation). queue it up on the background pool instead.
+        if (instantReverse.load() && isStandbyReady())
         {
-            float irDuration = *parameters.getRawParameterValue("decayTime");
-            bool reverse = *parameters.getRawParameterValue("reverseReverb") > 0.5f;
-            float proximity = *parameters.getRawParameterValue("proximity");
-            proximityParameter.store(proximity);
-            
-            auto newIR = createReverbImpulseResponse(irDuration, sampleRate, reverse, proximity);
-
-            // lock mutex and update the new IR buffer.
-            {
-                std::lock_guard<std::mutex> lock(irMutex);
-                newImpulseResponseBuffer = std::move(newIR);
-                irNeedsUpdate.store(true);
-            }
+            tailLengthSeconds.store(standbyTailLengthSeconds.load());
+            convolution.switchToStandby();
+            requestStandbyUpdate();
+        }
+        else
+        {
+            requestImpulseResponseUpdate();
         }
     }
+    else if (parameterID == "proximity")
+    {
+        // the early and late parts are balanced by the engine as it runs, so there's nothing to
+        // rebuild -- processBlock picks this up.
+        proximityParameter.store(newValue);
+    }
     else if (parameterID == "highPassFreq")
     {
         highPassCutoff.store(newValue);
@@ -943,9 +1541,54 @@ void SilkGhostAudioProcessor::parameterChanged(const juce::String& parameterID,
     {
         postGain.store(newValue);
     }
-    else if (parameterID == "signalQuality")
+    else if (parameterID == "qualityMode")
     {
+        // the lower modes run the engine at a fraction of the rate, with the latency of the
+        // resampling filters on top -- the host hears about that when the job's queued.
         signalQuality.store(static_cast<int>(newValue));
+        requestImpulseResponseUpdate();
+    }
+    else if (parameterID == "zeroLatency")
+    {
+        // build engines for the new mode in the background. the latency changes with it, and the
+        // host hears about that when the job's queued (see startImpulseResponseJob).
+        zeroLatency.store(newValue > 0.5f);
+        requestImpulseResponseUpdate();
+    }
+    else if (parameterID == "multibandDecay")
+    {
+        multiband.store(newValue > 0.5f);
+        requestImpulseResponseUpdate();
+    }
+    else if (parameterID == "trueStereo")
+    {
+        trueStereo.store(newValue > 0.5f);
+        requestImpulseResponseUpdate();
+    }
+    else if (parameterID == "hybridTail")
+    {
+        // the IR's the same either way, so this is just a new engine from the cached one.
+        hybridTail.store(newValue > 0.5f);
+        requestImpulseResponseUpdate();
+    }
+    else if (parameterID == "instantReverse")
+    {
+        // if it's switched off before a switch to the standby has gone through, the standby's
+        // about to be dropped, so the new orientation has to be built the slow way.
+        instantReverse.store(newValue > 0.5f);
+
+        if (! instantReverse.load() && convolution.isSwitchPending())
+            requestImpulseResponseUpdate();
+
+        requestStandbyUpdate();
+    }
+    else if (parameterID == "fixedInternalRate")
+    {
+        // this changes the rate nearly everything runs at, so it's a full re-prepare. that can't
+        // happen in here -- even a parameter that isn't automatable can be set from whatever
+        // thread the host likes -- so timerCallback() does it on the message thread.
+        fixedInternalRate.store(newValue > 0.5f);
+        internalRateChangePending.store(true);
     }
     else if (parameterID == "presetSelection")
     {
@@ -981,6 +1624,30 @@ void SilkGhostAudioProcessor::setStateInformation (const void* data, int sizeInB
     if (xmlState.get() != nullptr)
         if (xmlState->hasTagName (parameters.state.getType()))
             parameters.replaceState (juce::ValueTree::fromXml (*xmlState));
+
+    // pick the saved noise seed back up. sessions from before we stored it won't have one,
+    // so we keep ours and write it into the restored state instead.
+    if (parameters.state.hasProperty("irSeed"))
+        irSeed.store((juce::uint32) (juce::int64) parameters.state.getProperty("irSeed"));
+    else
+        parameters.state.setProperty("irSeed", (juce::int64) irSeed.load(), nullptr);
+
+    // the same goes for the noise floor, which older sessions had at the default.
+    if (parameters.state.hasProperty("noiseFloorDecibels"))
+        noiseFloorDecibels.store((float) parameters.state.getProperty("noiseFloorDecibels"));
+    else
+        parameters.state.setProperty("noiseFloorDecibels", noiseFloorDecibels.load(), nullptr);
+
+    requestImpulseResponseUpdate();
+}
+
+void SilkGhostAudioProcessor::setNoiseFloorDecibels(float newNoiseFloorDecibels)
+{
+    if (newNoiseFloorDecibels == noiseFloorDecibels.exchange(newNoiseFloorDecibels))
+        return;
+
+    parameters.state.setProperty("noiseFloorDecibels", newNoiseFloorDecibels, nullptr);
+    requestImpulseResponseUpdate();
 }
 
 juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
@@ -1,9 +1,15 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "ImpulseResponseCache.h"
+#include "ImpulseResponseDiskCache.h"
+#include "ImpulseResponseSynthesis.h"
+#include "CrossfadingConvolution.h"
+#include "PolyphaseResampling.h"
 
 class SilkGhostAudioProcessor  : public juce::AudioProcessor,
-                                 public juce::AudioProcessorValueTreeState::Listener
+                                 public juce::AudioProcessorValueTreeState::Listener,
+                                 private juce::Timer
 {
 public:
     SilkGhostAudioProcessor();
@@ -17,6 +23,7 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlockBypassed (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
 
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override;
@@ -60,27 +67,201 @@ public:
     // use JUCE's value tree to store parameters and manage state.
     juce::AudioProcessorValueTreeState parameters;
 
+    // how many convolution partitions the wet path holds, and how many it's running -- the rest
+    // are too quiet to be worth it, or past the end of the decay. safe to call from any thread.
+    int getNumPartitions() const { return convolution.getNumPartitions(); }
+    int getNumActivePartitions() const { return convolution.getNumActivePartitions(); }
+
+    // where IRs get cut off, in decibels below full scale. it's saved with the session, and
+    // changing it rebuilds the IR. call it from the message thread.
+    void setNoiseFloorDecibels(float newNoiseFloorDecibels);
+    float getNoiseFloorDecibels() const { return noiseFloorDecibels.load(); }
+
 private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SilkGhostAudioProcessor)
 
-    // declare a convolution engine, the crux of this plugin.
-    juce::dsp::Convolution convolution;
+    // declare a convolution engine, the crux of this plugin. new IRs are
+    // crossfaded in rather than swapped, so automating the decay doesn't click.
+    CrossfadingConvolution convolution;
 
-    // functions to create a parameter layout, generate impulse
-    // responses, and downsample IRs when we modify the signal quality.
-    juce::AudioBuffer<float> downsampleImpulseResponse(const juce::AudioBuffer<float>& impulseResponse, int factor);
+    // functions to create a parameter layout and generate impulse responses.
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
-    juce::AudioBuffer<float> createReverbImpulseResponse(float duration, double sampleRate, bool reverseReverb, float proximity);
+    juce::AudioBuffer<float> createReverbImpulseResponse(float duration, double sampleRate, bool reverseReverb,
+                                                         juce::uint32 seed, bool trueStereo, bool applyDecay,
+                                                         bool includeEarlyReflections, float floorDecibels,
+                                                         const std::function<bool()>& shouldCancel = nullptr);
+    static SparseTapDelay::Taps createEarlyReflections(juce::uint32 seed, bool trueStereo);
     float decayTime = 1.0f;
 
-    // set up variables to precompute the impulse responses --
-    // we're precomputing because recalculating the IR with each
-    // minute change a user makes to the Decay Time knob will
-    // *obliterate* CPU performance.
-    std::map<float, juce::AudioBuffer<float>> precomputedImpulseResponses;
-    const float minDecayTime = 0.5f;
-    const float maxDecayTime = 10.0f;
-    const float decayStep = 0.5f;
+    // where the late tail starts in every IR, and how long a forward IR gets built when the
+    // convolution engine is doing the decay for us -- the top of the decay time range.
+    static constexpr double lateStartSeconds = 0.1;
+    static constexpr float maximumDecayTime = 20.0f;
+
+    // IRs are cut off once they've dropped below the noise floor for good. there's nothing to
+    // hear past it, just more partitions to hold on to. a lower floor keeps more of a long tail
+    // for a quiet master, a higher one saves memory across a big session -- this is where it's
+    // always been.
+    static constexpr float defaultNoiseFloorDecibels = -96.0f;
+    std::atomic<float> noiseFloorDecibels { defaultNoiseFloorDecibels };
+
+    // an engine built in the background is handed over as soon as this much of the IR is ready
+    // to play, and the rest is loaded into it while it runs.
+    static constexpr double immediateLoadSeconds = 0.3;
+
+    // with the hybrid tail on, the engine's feedback delay network takes the tail over from here.
+    // the IR is noise by then, and from there on the network's cost doesn't grow with the decay.
+    static constexpr double feedbackStartSeconds = 0.3;
+
+    // how long an engine rings on for. one with a feedback tail follows any decay time without a
+    // rebuild, so that's as long as the longest decay takes to reach the noise floor.
+    static double getTailLength(const CrossfadingConvolution::Engine& engine, float floorDecibels);
+
+    // a snapshot of everything the IR depends on. we take it on the calling
+    // thread so that background jobs never have to touch the value tree.
+    struct ImpulseResponseSettings
+    {
+        float decayTime = 1.0f;
+        bool reverse = false;
+        double sampleRate = 0.0;        // the wet path's rate, which isn't always the host's.
+        int qualityMode = 0;
+        juce::uint32 seed = 0;
+        bool trueStereo = false;
+        bool hybridTail = false;
+        float noiseFloorDecibels = defaultNoiseFloorDecibels;
+
+        // what the convolution engine gets built for.
+        int maximumBlockSize = 0;
+        int numChannels = 0;
+        bool zeroLatency = false;
+        bool multiband = false;
+
+        // how far the wet path's rate is below the host's, for its latency at the host rate.
+        int internalRateFactor = 1;
+
+        // forward IRs are built with no decay on the tail, and the engine puts it on as it runs,
+        // so moving the decay time never needs a new IR. reverse ones still have it baked in --
+        // there the decay time decides where everything sits in the IR, not just how loud it is.
+        bool decaysInConvolution() const { return ! reverse; }
+
+        // the same goes for the early reflections: a forward IR is built without them, and the
+        // engine plays them from a tap delay instead, so its head partitions have nothing to do.
+        // in reverse they're at the far end of the IR, in among the tail, where they cost nothing
+        // extra.
+        bool reflectionsInTapDelay() const { return ! reverse; }
+
+        // and with the hybrid tail, the engine hands the tail over to a feedback delay network
+        // past feedbackStartSeconds. it follows the engine's decay, so it needs that too.
+        bool usesFeedbackTail() const { return hybridTail && decaysInConvolution(); }
+
+        // multiband splits the engine in two: the same IR twice, a long one for the low band at
+        // a quarter of the rate (or less), and a full-rate one for the high band that decays in
+        // half the time. it can't be done without decimating, so zero-latency mode turns it off.
+        bool splitsBands() const { return multiband && ! zeroLatency; }
+
+        // the settings for the high band's IR -- the same thing at the full rate.
+        ImpulseResponseSettings getHighBandSettings() const;
+
+        PartitionedConvolver::Scheme getConvolutionScheme() const;
+
+        // how far the engine's rate is cut down for the quality mode -- high runs at the full
+        // rate, then a half, a quarter and a sixth. splitting the bands takes it down to at least
+        // a quarter, which puts the crossover at around 5kHz.
+        int getDecimation() const;
+
+        // the latency of the whole wet path at the host rate: the engine's, and the fixed
+        // internal rate's resampling filters if there are any.
+        int getLatency() const;
+
+        // where the engine's decay takes over, and where the early part of the IR gives way to
+        // the late one -- which, in reverse, is at the other end. a forward IR is the full
+        // maximumDecayTime long, so it also gets cut off where the engine's decay takes it
+        // below the noise floor -- or the high band's, for its IR. the early reflections for the
+        // tap delay and the feedback start go in here too.
+        PartitionedConvolver::Layout getConvolutionLayout(const PreparedImpulseResponse& impulseResponse, bool highBand = false) const;
+
+        // where the spectra of an engine built with these settings live in the cache.
+        ImpulseResponseCache::SpectraKey getSpectraKey() const;
+    };
+    ImpulseResponseSettings getCurrentImpulseResponseSettings() const;
+
+    // gets the convolution-ready IR for these settings -- straight from irCache if we've built
+    // it before, otherwise we synthesise it, apply the quality mode, and cache the result.
+    // returns nullptr if shouldCancel fired along the way.
+    std::shared_ptr<const PreparedImpulseResponse> prepareImpulseResponse(const ImpulseResponseSettings& settings,
+                                                                          const std::function<bool()>& shouldCancel = nullptr);
+
+    // prepares whatever IRs these settings need and builds an engine from them, ready to hand
+    // to the convolution. with deferTail, only the head is built, and the rest is left for
+    // loadDeferredStages(). returns nullptr if shouldCancel fired along the way.
+    std::unique_ptr<CrossfadingConvolution::Engine> buildEngine(const ImpulseResponseSettings& settings,
+                                                                const std::function<bool()>& shouldCancel = nullptr,
+                                                                bool deferTail = false);
+
+    // puts an engine's spectra in irCache for the next engine built with these settings, if
+    // they're complete by now.
+    void cacheSpectra(const ImpulseResponseSettings& settings, std::shared_ptr<const CrossfadingConvolution::Engine::Spectra> spectra);
+
+    // ask for a rebuild of the IR. this can be the audio thread (parameterChanged runs there
+    // under automation), so all it does is mark every job in flight as stale and leave a flag
+    // for timerCallback(), which queues the job on irThreadPool from the message thread. bursts
+    // of requests (like a knob drag) coalesce: only the newest survives, and any stale job
+    // that's already running is told to bail out early.
+    void requestImpulseResponseUpdate();
+    void startImpulseResponseJob();
+    class ImpulseResponseJob;
+    std::atomic<juce::uint32> irGeneration { 0 };
+    std::atomic<bool> impulseResponseUpdatePending { false };
+
+    // set when fixedInternalRate changes, for timerCallback() to re-prepare us at the new rate.
+    std::atomic<bool> internalRateChangePending { false };
+
+    // how often the message thread checks for requests.
+    static constexpr int requestTimerHz = 30;
+    void timerCallback() override;
+
+    // how much of the IR the newest engine (and the standby) actually kept, in seconds. that's
+    // our tail, and in the forward mode it's also as long as the decay time can go before the
+    // engine needs building again.
+    std::atomic<double> tailLengthSeconds { 0.0 }, standbyTailLengthSeconds { 0.0 };
+
+    // with instant reverse on, every IR build also makes an engine for the other orientation
+    // and leaves it on standby in the convolution, so the Reverse button only has to crossfade.
+    // the standby has a generation of its own (every full request bumps it too), and it's only
+    // good to switch to once the job for the latest one has handed it over. requests work the
+    // same way as full ones: they're safe from any thread, and timerCallback() turns a burst of
+    // them into a single job -- or into dropping the standby, if instant reverse is off.
+    void requestStandbyUpdate();
+    void startStandbyJob();
+    std::atomic<bool> standbyUpdatePending { false };
+    bool isStandbyReady() const { return standbyReadyGeneration.load() == standbyGeneration.load(); }
+    std::atomic<juce::uint32> standbyGeneration { 0 };
+    std::atomic<juce::uint32> standbyReadyGeneration { std::numeric_limits<juce::uint32>::max() };
+
+    // a standby engine is skipped if it would take more than this, or more than an eighth
+    // of the machine's memory.
+    static constexpr size_t maximumStandbySizeInBytes = 512 * 1024 * 1024;
+
+    // every IR this instance builds uses the same noise seed, so a given set of
+    // parameters always produces exactly the same IR. it's saved with the plugin
+    // state, so reopening a session gives back the exact same reverb (and hits the
+    // disk cache instead of re-synthesising).
+    std::atomic<juce::uint32> irSeed;
+
+    // keep the IRs we've already built around -- recalculating the IR
+    // with each minute change a user makes to the Decay Time knob will
+    // *obliterate* CPU performance, and going back to a setting we've
+    // already heard shouldn't cost anything. the budget is in bytes.
+    static constexpr size_t irCacheSizeInBytes = 256 * 1024 * 1024;
+    ImpulseResponseCache irCache { irCacheSizeInBytes };
+
+    // finished IRs also go to disk, shared between every instance on the machine, so
+    // loading a big session maps them back in rather than building them all again.
+    juce::SharedResourcePointer<ImpulseResponseDiskCache> irDiskCache;
+
+    // the threads the late tail is rendered on, also shared between every instance. holding
+    // on to it here keeps them alive from one build to the next.
+    juce::SharedResourcePointer<ImpulseResponseSynthesis::WorkerPool> synthesisWorkers;
     bool reverseReverb = false;
     
     // build some variables using JUCE classes to control
@@ -104,23 +285,66 @@ private:
     std::atomic<float> highPassCutoff { 200.0f };
     std::atomic<float> lowPassCutoff { 18000.0f };
     std::atomic<float> postGain { 0.0f };
-    std::atomic<int> signalQuality;
+    std::atomic<int> signalQuality { 0 };
+    std::atomic<bool> zeroLatency { false };
+    std::atomic<bool> trueStereo { false };
+    std::atomic<bool> hybridTail { false };
+    std::atomic<bool> instantReverse { false };
+    std::atomic<bool> fixedInternalRate { false };
+    std::atomic<bool> multiband { false };
+
+    // with fixedInternalRate on, at high host rates the whole wet path -- pre-delay to filters --
+    // runs at the host rate divided by this, between a pair of resampling filters. it's decided
+    // in prepareToPlay and stays put until the next one.
+    static int getInternalRateFactor(double hostSampleRate, bool useFixedRate);
+    int getWetLatency(int convolutionLatency) const;
+    void processWetPath(juce::dsp::AudioBlock<float>& block);
+    std::atomic<int> internalRateFactor { 1 };
+    PolyphaseResampling::Decimator wetDecimator;
+    PolyphaseResampling::Interpolator wetInterpolator;
+    juce::AudioBuffer<float> decimatedWetBuffer;
+    std::vector<float*> wetChannels;
+
+    // the latency the dry path is currently delayed by. the engine's latency
+    // changes when we switch in or out of zero-latency mode, and processBlock
+    // keeps the mixer in step with it.
+    int wetLatency = 0;
+
+    // everything processBlock and processBlockBypassed do. bypassed, the input stops going into
+    // the reverb, but whatever's already in there rings out over the dry signal.
+    void processAudio(juce::AudioBuffer<float>& buffer, bool bypassed);
+
+    // the wet path goes to sleep once the input's been silent for long enough that everything it
+    // was last given has rung out, and wakes again as soon as there's anything to hear -- an idle
+    // send in a big session then costs next to nothing. samplesSinceInput counts the host
+    // samples since the last block with anything in it.
+    static constexpr float silenceThresholdDecibels = -120.0f;
+    static constexpr double ringOutMarginSeconds = 0.1;
+    bool isInputSilent(const juce::AudioBuffer<float>& buffer) const;
+    juce::int64 getRingOutSamples() const;
+    juce::int64 samplesSinceInput = 0;
 
-    // need to use a mutex to update the IR within the thread safely as
-    // well -- failure to do so will cause race conditions!
-    std::mutex irMutex;
-    std::atomic<bool> irNeedsUpdate { false };
-    juce::AudioBuffer<float> newImpulseResponseBuffer;
+    // the dry signal goes into this ring as well, so that when we're bypassed it can come out
+    // delayed by our latency but at full level, whatever the wet mix. the mixer's kept running
+    // alongside on bypassBuffer, so nothing jumps when we come back.
+    juce::AudioBuffer<float> dryHistory;
+    juce::int64 dryHistoryPosition = 0;
+    juce::AudioBuffer<float> bypassBuffer;
 
     // declare a thread pool so that we can move resources to the thread
     // vs. updating directly on the buffer, which will cause really
-    // poor performance stemming from extreme CPU usage.
+    // poor performance stemming from extreme CPU usage. every IR rebuild
+    // goes through here as an ImpulseResponseJob.
     juce::ThreadPool irThreadPool;
 
     // use JUCE's built-in DryWetMixer to mix the signal easily --
     // it's a bit tough to get equilibrium between a dry and wet signal
     // manually because we need to factor in latency, and WetDryMixer
     // does that for us automatically.
-    juce::dsp::DryWetMixer<float> dryWetMixer;
+    // the wet path now has latency (the convolution's head partition, and
+    // any resampling filters), so the mixer needs room to delay the dry
+    // signal to match.
+    static constexpr int maximumWetLatencyInSamples = 8192;
+    juce::dsp::DryWetMixer<float> dryWetMixer { maximumWetLatencyInSamples };
         
 };
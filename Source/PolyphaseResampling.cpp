@@ -0,0 +1,225 @@
+/*
+  ==============================================================================
+    PolyphaseResampling.cpp
+    Created: 17 Oct 2026
+  ==============================================================================
+*/
+
+#include "PolyphaseResampling.h"
+
+#if JUCE_INTEL
+ #include <emmintrin.h>
+#endif
+
+namespace PolyphaseResampling
+{
+namespace
+{
+    // the lowpass both sides use, at the host rate: cut off at 90% of the lower rate's Nyquist,
+    // with a Kaiser window (beta 6, around 60dB down in the stopband). it sums to one.
+    std::vector<float> designLowpass(int factor)
+    {
+        const int length = tapsPerPhase * factor;
+        const double cutoff = 0.45 / factor;
+        const double beta = 6.0;
+        const double centre = 0.5 * (length - 1);
+
+        auto besselI0 = [](double x)
+        {
+            double sum = 1.0, term = 1.0;
+            for (int k = 1; k < 50 && term > 1.0e-12 * sum; ++k)
+            {
+                term *= (0.5 * x / k) * (0.5 * x / k);
+                sum += term;
+            }
+
+            return sum;
+        };
+
+        std::vector<double> taps((size_t) length);
+        double total = 0.0;
+
+        for (int n = 0; n < length; ++n)
+        {
+            const double x = n - centre;
+            const double sinc = x == 0.0 ? 2.0 * cutoff : std::sin(juce::MathConstants<double>::twoPi * cutoff * x) / (juce::MathConstants<double>::pi * x);
+            const double r = x / (centre + 0.5);
+
+            taps[(size_t) n] = sinc * besselI0(beta * std::sqrt(juce::jmax(0.0, 1.0 - r * r))) / besselI0(beta);
+            total += taps[(size_t) n];
+        }
+
+        std::vector<float> coefficients((size_t) length);
+        for (int n = 0; n < length; ++n)
+            coefficients[(size_t) n] = (float) (taps[(size_t) n] / total);
+
+        return coefficients;
+    }
+
+    // every filter length here is a multiple of tapsPerPhase, so of four as well. SSE2 is there
+    // on every x86-64 CPU, so there's nothing to check first -- anywhere else, the compiler's
+    // left to vectorise the plain loop itself.
+    float dotProduct(const float* a, const float* b, int length) noexcept
+    {
+       #if JUCE_INTEL
+        __m128 sum0 = _mm_setzero_ps(), sum1 = _mm_setzero_ps();
+        int i = 0;
+
+        for (; i + 8 <= length; i += 8)
+        {
+            sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+            sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+        }
+
+        for (; i + 4 <= length; i += 4)
+            sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+
+        alignas (16) float lanes[4];
+        _mm_store_ps(lanes, _mm_add_ps(sum0, sum1));
+        float sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+       #else
+        float sum = 0.0f;
+        int i = 0;
+       #endif
+
+        for (; i < length; ++i)
+            sum += a[i] * b[i];
+
+        return sum;
+    }
+}
+
+std::vector<float> getRoundTripResponse(int factor)
+{
+    jassert(factor > 1);
+
+    const auto lowpass = designLowpass(factor);
+    const auto length = lowpass.size();
+    std::vector<float> response(length * 2 - 1, 0.0f);
+
+    for (size_t i = 0; i < length; ++i)
+        for (size_t j = 0; j < length; ++j)
+            response[i + j] += lowpass[i] * lowpass[j];
+
+    return response;
+}
+
+void Decimator::prepare(int newFactor, int numChannels)
+{
+    jassert(newFactor >= 1);
+
+    factor = newFactor;
+    coefficients = designLowpass(factor);
+    history.setSize(numChannels, (int) coefficients.size() * 2);
+    reset();
+}
+
+void Decimator::reset()
+{
+    history.clear();
+    position = 0;
+    phase = 0;
+}
+
+int Decimator::process(const float* const* input, float* const* output, int numChannels, int numSamples) noexcept
+{
+    const int length = (int) coefficients.size();
+    int numOutputs = 0, endPosition = position, endPhase = phase;
+
+    // every channel does the same thing from the same starting point, so the last one's
+    // position and phase are where we carry on from next time.
+    for (int c = 0; c < numChannels; ++c)
+    {
+        auto* buffer = history.getWritePointer(c);
+        int p = position, ph = phase;
+        numOutputs = 0;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            p = (p == 0 ? length : p) - 1;
+            buffer[p] = buffer[p + length] = input[c][i];
+
+            if (++ph == factor)
+            {
+                ph = 0;
+                output[c][numOutputs++] = dotProduct(coefficients.data(), buffer + p, length);
+            }
+        }
+
+        endPosition = p;
+        endPhase = ph;
+    }
+
+    position = endPosition;
+    phase = endPhase;
+    return numOutputs;
+}
+
+void Interpolator::prepare(int newFactor, int numChannels, int maximumBlockSize)
+{
+    jassert(newFactor >= 1);
+
+    factor = newFactor;
+
+    // phase j takes taps j, j + factor, j + 2 * factor... and the gain of factor that makes
+    // up for the zeros we're not stuffing in.
+    const auto lowpass = designLowpass(factor);
+    phaseCoefficients.resize(lowpass.size());
+
+    for (int j = 0; j < factor; ++j)
+        for (int i = 0; i < tapsPerPhase; ++i)
+            phaseCoefficients[(size_t) (j * tapsPerPhase + i)] = (float) factor * lowpass[(size_t) (i * factor + j)];
+
+    history.setSize(numChannels, tapsPerPhase * 2);
+
+    // enough for a block's worth of output, plus what can be left over from the last one.
+    const int queueSize = juce::nextPowerOfTwo(maximumBlockSize + 2 * factor);
+    queue.setSize(numChannels, queueSize);
+    queueMask = queueSize - 1;
+
+    reset();
+}
+
+void Interpolator::reset()
+{
+    history.clear();
+    queue.clear();
+    position = 0;
+    readPosition = 0;
+    writePosition = factor - 1;
+}
+
+void Interpolator::process(const float* const* input, int numInputs, float* const* output, int numChannels, int numSamples) noexcept
+{
+    jassert(writePosition + (juce::int64) numInputs * factor - readPosition >= numSamples);
+
+    int endPosition = position;
+
+    for (int c = 0; c < numChannels; ++c)
+    {
+        auto* buffer = history.getWritePointer(c);
+        auto* fifo = queue.getWritePointer(c);
+        int p = position;
+        auto write = writePosition;
+
+        for (int i = 0; i < numInputs; ++i)
+        {
+            p = (p == 0 ? tapsPerPhase : p) - 1;
+            buffer[p] = buffer[p + tapsPerPhase] = input[c][i];
+
+            for (int j = 0; j < factor; ++j)
+                fifo[write++ & queueMask] = dotProduct(phaseCoefficients.data() + j * tapsPerPhase, buffer + p, tapsPerPhase);
+        }
+
+        auto read = readPosition;
+        for (int i = 0; i < numSamples; ++i)
+            output[c][i] = fifo[read++ & queueMask];
+
+        endPosition = p;
+    }
+
+    position = endPosition;
+    writePosition += (juce::int64) numInputs * factor;
+    readPosition += numSamples;
+}
+}
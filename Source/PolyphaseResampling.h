@@ -0,0 +1,91 @@
+/*
+  ==============================================================================
+    PolyphaseResampling.h
+    Created: 17 Oct 2026
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// the filters for running part of the signal chain at a whole-number fraction of the host rate:
+// a decimator to take the signal down, and an interpolator to bring it back up. both use the
+// same linear-phase lowpass -- a Kaiser-windowed sinc, cut off just under the lower rate's
+// Nyquist -- to keep aliases out on the way down and images out on the way up.
+//
+// both are polyphase: the decimator only works out the samples it keeps, and the interpolator
+// never multiplies by the zeros it would otherwise have stuffed in. so either one costs
+// tapsPerPhase multiply-adds per host-rate sample, whatever the factor.
+namespace PolyphaseResampling
+{
+    // the filter is this many taps long for every step of the factor.
+    constexpr int tapsPerPhase = 32;
+
+    // the delay the pair of them add between them, at the host rate, on top of whatever runs
+    // at the lower rate in between.
+    constexpr int getLatency(int factor) { return factor > 1 ? tapsPerPhase * factor - 1 : 0; }
+
+    // what a decimator and an interpolator in a row do to a signal, as one filter at the host
+    // rate (leaving out the little that aliases): the lowpass convolved with itself. it's
+    // linear-phase, centred on getLatency(factor).
+    std::vector<float> getRoundTripResponse(int factor);
+
+    class Decimator
+    {
+    public:
+        Decimator() = default;
+
+        void prepare(int factor, int numChannels);
+        void reset();
+
+        // takes numSamples of input on each channel, and writes one sample to output for every
+        // factor that go in -- counting across calls, so the blocks don't have to line up.
+        // returns how many it wrote, which is at most numSamples / factor + 1.
+        int process(const float* const* input, float* const* output, int numChannels, int numSamples) noexcept;
+
+    private:
+        int factor = 1;
+        std::vector<float> coefficients;
+
+        // the last coefficients.size() inputs per channel, newest first, written twice over so
+        // the filter can always read them in one straight run.
+        juce::AudioBuffer<float> history;
+        int position = 0;
+        int phase = 0;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Decimator)
+    };
+
+    class Interpolator
+    {
+    public:
+        Interpolator() = default;
+
+        void prepare(int factor, int numChannels, int maximumBlockSize);
+        void reset();
+
+        // takes numInputs samples at the lower rate on each channel, and writes numSamples at
+        // the host rate. the two only have to agree on average, the way a Decimator's output
+        // does with its input: the difference is made up by a small queue, which starts off
+        // holding factor - 1 samples of silence.
+        void process(const float* const* input, int numInputs, float* const* output, int numChannels, int numSamples) noexcept;
+
+    private:
+        int factor = 1;
+
+        // the filter split into its phases, each tapsPerPhase long: phase j makes every output
+        // that's j samples after an input.
+        std::vector<float> phaseCoefficients;
+
+        // the last tapsPerPhase inputs per channel, newest first and written twice over, like
+        // the decimator's.
+        juce::AudioBuffer<float> history;
+        int position = 0;
+
+        juce::AudioBuffer<float> queue;
+        juce::int64 queueMask = 0, writePosition = 0, readPosition = 0;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Interpolator)
+    };
+}
@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+    RealtimeHandoff.h
+    Created: 17 Oct 2026
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// a wait-free mailbox for passing fully built objects from a background thread to the audio
+// thread, without the audio thread ever having to lock, allocate or free anything.
+//
+// the builder publishes an object into a single atomic slot (if the audio thread never got
+// round to the previous one, it's simply replaced and deleted on the builder's side). the audio
+// thread swaps the newest object in with a single atomic exchange, and the object it was using
+// before goes onto a small lock-free FIFO of retired objects instead of being deleted on the
+// spot. those get destroyed later by collectGarbage(), which runs on whatever non-realtime
+// thread calls it -- publish() does it automatically.
+template <typename ObjectType, int retiredCapacity = 16>
+class RealtimeHandoff
+{
+public:
+    RealtimeHandoff() = default;
+
+    ~RealtimeHandoff()
+    {
+        delete pending.exchange(nullptr);
+        collectGarbage();
+    }
+
+    // call from any thread except the audio thread.
+    void publish(std::unique_ptr<ObjectType> newObject)
+    {
+        delete pending.exchange(newObject.release(), std::memory_order_acq_rel);
+        collectGarbage();
+    }
+
+    // throws away anything published that the audio thread hasn't picked up yet. again, not
+    // for the audio thread.
+    void discardPending()
+    {
+        delete pending.exchange(nullptr, std::memory_order_acq_rel);
+        collectGarbage();
+    }
+
+    // audio thread only. if something new has been published, it's swapped into current, and
+    // whatever current held before is retired. returns true if current changed.
+    //
+    // if the retired FIFO is full (the background side hasn't collected for a while), we leave
+    // the new object waiting for the next block rather than block or free anything here.
+    bool acquire(std::unique_ptr<ObjectType>& current) noexcept
+    {
+        if (pending.load(std::memory_order_relaxed) == nullptr || retiredFifo.getFreeSpace() == 0)
+            return false;
+
+        auto* incoming = pending.exchange(nullptr, std::memory_order_acq_rel);
+        if (incoming == nullptr)
+            return false;
+
+        if (current != nullptr)
+            retire(current.release());
+
+        current.reset(incoming);
+        return true;
+    }
+
+    // audio thread only. hands an object over to be destroyed on a background thread. returns
+    // false (and leaves the object alone) if there's no room left.
+    bool retire(ObjectType* object) noexcept
+    {
+        if (object == nullptr)
+            return true;
+
+        const auto scope = retiredFifo.write(1);
+        if (scope.blockSize1 + scope.blockSize2 == 0)
+            return false;
+
+        retired[(size_t) (scope.blockSize1 > 0 ? scope.startIndex1 : scope.startIndex2)] = object;
+        return true;
+    }
+
+    // deletes everything the audio thread has retired. call from any non-realtime thread.
+    void collectGarbage()
+    {
+        const juce::ScopedLock sl(collectLock);
+
+        for (;;)
+        {
+            const auto scope = retiredFifo.read(1);
+            if (scope.blockSize1 + scope.blockSize2 == 0)
+                break;
+
+            auto& slot = retired[(size_t) (scope.blockSize1 > 0 ? scope.startIndex1 : scope.startIndex2)];
+            delete slot;
+            slot = nullptr;
+        }
+    }
+
+private:
+    std::atomic<ObjectType*> pending { nullptr };
+
+    juce::AbstractFifo retiredFifo { retiredCapacity };
+    std::array<ObjectType*, (size_t) retiredCapacity> retired {};
+
+    // the FIFO only allows one reader at a time, and collectGarbage() can be called from a few
+    // different background threads.
+    juce::CriticalSection collectLock;
+
+    JUCE_DECLARE_NON_COPYABLE (RealtimeHandoff)
+};
@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+    SparseTapDelay.cpp
+    Created: 17 Oct 2026
+  ==============================================================================
+*/
+
+#include "SparseTapDelay.h"
+
+void SparseTapDelay::setTaps(const Taps& taps, double sampleRate, int extraDelay, int numChannels, int maximumBlockSize)
+{
+    jassert(taps.gains.getNumSamples() == taps.getNumTaps());
+
+    delays.resize((size_t) taps.getNumTaps());
+    for (size_t i = 0; i < delays.size(); ++i)
+        delays[i] = juce::roundToInt(taps.times[i] * sampleRate) + extraDelay;
+
+    gains.makeCopyOf(taps.gains);
+
+    // the oldest sample a block can need is the longest delay back from its start.
+    const int longestDelay = delays.empty() ? 0 : *std::max_element(delays.begin(), delays.end());
+    const int historySize = juce::nextPowerOfTwo(longestDelay + maximumBlockSize);
+    history.setSize(numChannels, historySize);
+    historyMask = historySize - 1;
+
+    reset();
+}
+
+void SparseTapDelay::clear()
+{
+    delays.clear();
+    gains.setSize(0, 0);
+    history.setSize(0, 0);
+    historyMask = 0;
+    samplesPushed = 0;
+}
+
+void SparseTapDelay::reset()
+{
+    history.clear();
+    samplesPushed = 0;
+}
+
+void SparseTapDelay::pushInput(const float* const* input, int numChannels, int numSamples) noexcept
+{
+    const int size = history.getNumSamples();
+    const auto start = (int) (samplesPushed & historyMask);
+    const int firstRun = juce::jmin(numSamples, size - start);
+
+    for (int c = 0; c < juce::jmin(numChannels, history.getNumChannels()); ++c)
+    {
+        auto* ring = history.getWritePointer(c);
+        juce::FloatVectorOperations::copy(ring + start, input[c], firstRun);
+        juce::FloatVectorOperations::copy(ring, input[c] + firstRun, numSamples - firstRun);
+    }
+
+    samplesPushed += numSamples;
+}
+
+void SparseTapDelay::addPath(int inputChannel, int path, float* output, int numSamples) const noexcept
+{
+    const int size = history.getNumSamples();
+    const auto* ring = history.getReadPointer(inputChannel);
+    const auto* pathGains = gains.getReadPointer(path);
+    const auto blockStart = samplesPushed - numSamples;
+
+    for (size_t i = 0; i < delays.size(); ++i)
+    {
+        const auto gain = pathGains[i];
+        if (gain == 0.0f)
+            continue;
+
+        const auto start = (int) ((blockStart - delays[i]) & historyMask);
+        const int firstRun = juce::jmin(numSamples, size - start);
+
+        juce::FloatVectorOperations::addWithMultiply(output, ring + start, gain, firstRun);
+        juce::FloatVectorOperations::addWithMultiply(output + firstRun, ring, gain, numSamples - firstRun);
+    }
+}
@@ -0,0 +1,63 @@
+/*
+  ==============================================================================
+    SparseTapDelay.h
+    Created: 17 Oct 2026
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// a multi-tap delay for the early reflections. a dozen single impulses in the first 50ms of an
+// IR cost next to nothing on their own, but left in the IR they're paid for by every head
+// partition, on every block -- and they keep the convolution from skipping the silence around
+// them. here each one is just a gain on a delayed copy of the input.
+//
+// the input goes into a ring, and every tap reads a block's worth back out of it in one straight
+// run (two, if it wraps), so each tap is a single vectorised multiply-add across the block. the
+// taps share one set of delays, with a gain (sign included) per tap on each path -- the same
+// paths as the IR they were taken out of.
+class SparseTapDelay
+{
+public:
+    // the reflections, in the same terms as an IR: the time of each (in seconds into the IR) and
+    // its gain on each path, one channel per path and one sample per tap.
+    struct Taps
+    {
+        std::vector<double> times;
+        juce::AudioBuffer<float> gains;
+
+        int getNumTaps() const { return (int) times.size(); }
+    };
+
+    SparseTapDelay() = default;
+
+    // sets the taps up at this rate, with extraDelay samples on top of every one of them (to line
+    // them up with a convolution's latency), and makes room for blocks of up to maximumBlockSize.
+    // allocates, so not for the audio thread.
+    void setTaps(const Taps& taps, double sampleRate, int extraDelay, int numChannels, int maximumBlockSize);
+    void clear();
+    void reset();
+
+    int getNumTaps() const { return (int) delays.size(); }
+    int getNumPaths() const { return gains.getNumChannels(); }
+
+    // puts the next numSamples of input into the ring, for addPath() to read from.
+    void pushInput(const float* const* input, int numChannels, int numSamples) noexcept;
+
+    // adds what one path's taps make of one input channel, for the block that was just pushed,
+    // onto output.
+    void addPath(int inputChannel, int path, float* output, int numSamples) const noexcept;
+
+private:
+    std::vector<int> delays;
+    juce::AudioBuffer<float> gains;
+
+    // the input, indexed by absolute sample time.
+    juce::AudioBuffer<float> history;
+    juce::int64 historyMask = 0;
+    juce::int64 samplesPushed = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SparseTapDelay)
+};
@@ -0,0 +1,179 @@
+/*
+  ==============================================================================
+    SpectralKernels.cpp
+    Created: 17 Oct 2026
+  ==============================================================================
+*/
+
+#include "SpectralKernels.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+
+ // as with the IR synthesis kernels, these get compiled for instruction sets the rest of the
+ // plugin isn't, and only ever run after checking the CPU has them.
+ #if JUCE_MSVC
+  #define SILKGHOST_TARGET_AVX2_FMA
+  #define SILKGHOST_TARGET_AVX512
+ #else
+  #define SILKGHOST_TARGET_AVX2_FMA __attribute__ ((target ("avx2,fma")))
+  #define SILKGHOST_TARGET_AVX512 __attribute__ ((target ("avx512f")))
+ #endif
+#endif
+
+namespace SpectralKernels
+{
+namespace
+{
+    void multiplyAccumulateScalar(float* accumulator, const float* a, const float* b, float gain, int numBins) noexcept
+    {
+        for (int i = 0; i < numBins; ++i)
+        {
+            const auto ar = a[2 * i], ai = a[2 * i + 1];
+            const auto br = b[2 * i], bi = b[2 * i + 1];
+            accumulator[2 * i]     += gain * (ar * br - ai * bi);
+            accumulator[2 * i + 1] += gain * (ar * bi + ai * br);
+        }
+    }
+
+   #if JUCE_INTEL
+    // all three vector kernels do the same thing, just at different widths. for each pair of
+    // floats (re, im):
+    //
+    //   a * (br, br) = (ar.br, ai.br)
+    //   swap(a) * (bi, bi) = (ai.bi, ar.bi)
+    //
+    // and subtracting the second from the first in the real slots, adding in the imaginary ones,
+    // gives (ar.br - ai.bi, ai.br + ar.bi) -- the complex product, which is then scaled by the
+    // gain on its way into the accumulator.
+
+    void multiplyAccumulateSSE2(float* accumulator, const float* a, const float* b, float gain, int numBins) noexcept
+    {
+        const __m128 negateReal = _mm_castsi128_ps(_mm_setr_epi32((int) 0x80000000, 0, (int) 0x80000000, 0));
+        const __m128 scale = _mm_set1_ps(gain);
+
+        int i = 0;
+        for (; i + 2 <= numBins; i += 2)
+        {
+            const __m128 va = _mm_loadu_ps(a + 2 * i);
+            const __m128 vb = _mm_loadu_ps(b + 2 * i);
+
+            const __m128 bReal = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(2, 2, 0, 0));
+            const __m128 bImag = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(3, 3, 1, 1));
+            const __m128 aSwapped = _mm_shuffle_ps(va, va, _MM_SHUFFLE(2, 3, 0, 1));
+
+            const __m128 cross = _mm_xor_ps(_mm_mul_ps(aSwapped, bImag), negateReal);
+            const __m128 product = _mm_add_ps(_mm_mul_ps(va, bReal), cross);
+
+            _mm_storeu_ps(accumulator + 2 * i, _mm_add_ps(_mm_loadu_ps(accumulator + 2 * i), _mm_mul_ps(product, scale)));
+        }
+
+        multiplyAccumulateScalar(accumulator + 2 * i, a + 2 * i, b + 2 * i, gain, numBins - i);
+    }
+
+    SILKGHOST_TARGET_AVX2_FMA void multiplyAccumulateAVX2(float* accumulator, const float* a, const float* b, float gain, int numBins) noexcept
+    {
+        const __m256 scale = _mm256_set1_ps(gain);
+
+        int i = 0;
+        for (; i + 4 <= numBins; i += 4)
+        {
+            const __m256 va = _mm256_loadu_ps(a + 2 * i);
+            const __m256 vb = _mm256_loadu_ps(b + 2 * i);
+
+            const __m256 bReal = _mm256_moveldup_ps(vb);
+            const __m256 bImag = _mm256_movehdup_ps(vb);
+            const __m256 aSwapped = _mm256_permute_ps(va, _MM_SHUFFLE(2, 3, 0, 1));
+
+            const __m256 product = _mm256_fmaddsub_ps(va, bReal, _mm256_mul_ps(aSwapped, bImag));
+            _mm256_storeu_ps(accumulator + 2 * i, _mm256_fmadd_ps(product, scale, _mm256_loadu_ps(accumulator + 2 * i)));
+        }
+
+        // the tail goes through the (non-VEX) SSE2 kernel, so clear the upper halves first or
+        // every instruction in it pays for the AVX/SSE transition.
+        _mm256_zeroupper();
+        multiplyAccumulateSSE2(accumulator + 2 * i, a + 2 * i, b + 2 * i, gain, numBins - i);
+    }
+
+    SILKGHOST_TARGET_AVX512 void multiplyAccumulateAVX512(float* accumulator, const float* a, const float* b, float gain, int numBins) noexcept
+    {
+        const __m512 scale = _mm512_set1_ps(gain);
+
+        int i = 0;
+        for (; i + 8 <= numBins; i += 8)
+        {
+            const __m512 va = _mm512_loadu_ps(a + 2 * i);
+            const __m512 vb = _mm512_loadu_ps(b + 2 * i);
+
+            const __m512 bReal = _mm512_moveldup_ps(vb);
+            const __m512 bImag = _mm512_movehdup_ps(vb);
+            const __m512 aSwapped = _mm512_permute_ps(va, _MM_SHUFFLE(2, 3, 0, 1));
+
+            const __m512 product = _mm512_fmaddsub_ps(va, bReal, _mm512_mul_ps(aSwapped, bImag));
+            _mm512_storeu_ps(accumulator + 2 * i, _mm512_fmadd_ps(product, scale, _mm512_loadu_ps(accumulator + 2 * i)));
+        }
+
+        _mm256_zeroupper();
+        multiplyAccumulateSSE2(accumulator + 2 * i, a + 2 * i, b + 2 * i, gain, numBins - i);
+    }
+   #endif
+}
+
+Instructions getBestAvailableInstructions()
+{
+    static const auto best = isAvailable(Instructions::avx512) ? Instructions::avx512
+                           : isAvailable(Instructions::avx2)   ? Instructions::avx2
+                           : isAvailable(Instructions::sse2)   ? Instructions::sse2
+                                                               : Instructions::scalar;
+    return best;
+}
+
+bool isAvailable(Instructions instructions)
+{
+   #if JUCE_INTEL
+    switch (instructions)
+    {
+        case Instructions::scalar:  return true;
+        case Instructions::sse2:    return juce::SystemStats::hasSSE2();
+        case Instructions::avx2:    return juce::SystemStats::hasAVX2() && juce::SystemStats::hasFMA3();
+        case Instructions::avx512:  return juce::SystemStats::hasAVX512F();
+    }
+
+    return false;
+   #else
+    return instructions == Instructions::scalar;
+   #endif
+}
+
+const char* getName(Instructions instructions)
+{
+    switch (instructions)
+    {
+        case Instructions::scalar:  return "scalar";
+        case Instructions::sse2:    return "SSE2";
+        case Instructions::avx2:    return "AVX2/FMA";
+        case Instructions::avx512:  return "AVX-512";
+    }
+
+    return "unknown";
+}
+
+MultiplyAccumulate getMultiplyAccumulate(Instructions instructions)
+{
+    jassert(isAvailable(instructions));
+
+   #if JUCE_INTEL
+    switch (instructions)
+    {
+        case Instructions::avx512:  return &multiplyAccumulateAVX512;
+        case Instructions::avx2:    return &multiplyAccumulateAVX2;
+        case Instructions::sse2:    return &multiplyAccumulateSSE2;
+        case Instructions::scalar:  break;
+    }
+   #else
+    juce::ignoreUnused(instructions);
+   #endif
+
+    return &multiplyAccumulateScalar;
+}
+}
@@ -0,0 +1,38 @@
+/*
+  ==============================================================================
+    SpectralKernels.h
+    Created: 17 Oct 2026
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// the inner loop of the partitioned convolver: multiplying input spectra by IR spectra and
+// summing them up. with a long tail that's hundreds of partitions of thousands of bins for every
+// block, so it's worth having hand-vectorised versions -- SSE2, AVX2 with FMA, and AVX-512 --
+// picked at runtime from what the CPU supports. the scalar version is the reference the others
+// are checked against, and the fallback everywhere else (arm64 included).
+//
+// spectra are interleaved (re, im) pairs, the same layout JUCE's real-only FFT produces.
+namespace SpectralKernels
+{
+    enum class Instructions
+    {
+        scalar,
+        sse2,
+        avx2,
+        avx512
+    };
+
+    // the widest instruction set this machine can run.
+    Instructions getBestAvailableInstructions();
+    bool isAvailable(Instructions instructions);
+    const char* getName(Instructions instructions);
+
+    // accumulator += gain * a * b, over numBins complex values.
+    using MultiplyAccumulate = void (*)(float* accumulator, const float* a, const float* b, float gain, int numBins) noexcept;
+
+    MultiplyAccumulate getMultiplyAccumulate(Instructions instructions = getBestAvailableInstructions());
+}
@@ -0,0 +1,136 @@
+/*
+  ==============================================================================
+    ImpulseResponseCacheTests.cpp
+    Created: 17 Oct 2026
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/ImpulseResponseCache.h"
+
+namespace
+{
+    // a silent mono IR -- only its size matters here, which is 4 bytes a sample.
+    std::shared_ptr<const PreparedImpulseResponse> makeImpulseResponse(int numSamples)
+    {
+        auto impulseResponse = std::make_shared<PreparedImpulseResponse>();
+        impulseResponse->buffer.setSize(1, numSamples);
+        impulseResponse->buffer.clear();
+        impulseResponse->sampleRate = 48000.0;
+        return impulseResponse;
+    }
+
+    ImpulseResponseCache::Key makeKey(juce::uint32 seed)
+    {
+        return { 2.5f, false, 48000.0, 1, seed };
+    }
+}
+
+// the byte budget and the order entries get thrown out in, for both kinds of entry.
+class ImpulseResponseCacheTests : public juce::UnitTest
+{
+public:
+    ImpulseResponseCacheTests() : juce::UnitTest("ImpulseResponseCache", "SilkGhost") {}
+
+    void runTest() override
+    {
+        testEviction();
+        testReplacing();
+        testOversizeEntries();
+        testSharedBudget();
+    }
+
+private:
+    // 4000 bytes.
+    static constexpr int entryLength = 1000;
+    static constexpr size_t entrySize = entryLength * sizeof(float);
+
+    void testEviction()
+    {
+        beginTest("Evicts the least recently used entries to stay within budget");
+
+        ImpulseResponseCache cache(3 * entrySize);
+        for (juce::uint32 seed = 1; seed <= 3; ++seed)
+            cache.insert(makeKey(seed), makeImpulseResponse(entryLength));
+
+        expectEquals(cache.getCurrentSize(), 3 * entrySize);
+
+        // using the oldest makes the second one the least recently used.
+        expect(cache.get(makeKey(1)) != nullptr);
+        cache.insert(makeKey(4), makeImpulseResponse(entryLength));
+
+        expect(cache.get(makeKey(2)) == nullptr, "the least recently used should have gone");
+        expect(cache.get(makeKey(1)) != nullptr && cache.get(makeKey(3)) != nullptr && cache.get(makeKey(4)) != nullptr);
+        expectEquals(cache.getCurrentSize(), 3 * entrySize);
+
+        // and the same when the budget shrinks, which leaves the two used last.
+        cache.setMaximumSize(2 * entrySize);
+        expect(cache.get(makeKey(1)) == nullptr);
+        expect(cache.get(makeKey(3)) != nullptr && cache.get(makeKey(4)) != nullptr);
+        expectEquals(cache.getCurrentSize(), 2 * entrySize);
+    }
+
+    void testReplacing()
+    {
+        beginTest("Inserting an existing key replaces the entry");
+
+        ImpulseResponseCache cache(3 * entrySize);
+        cache.insert(makeKey(1), makeImpulseResponse(entryLength));
+
+        const auto replacement = makeImpulseResponse(2 * entryLength);
+        cache.insert(makeKey(1), replacement);
+
+        expect(cache.get(makeKey(1)) == replacement);
+        expectEquals(cache.getCurrentSize(), 2 * entrySize, "the old entry's size should have been taken off");
+    }
+
+    void testOversizeEntries()
+    {
+        beginTest("An entry bigger than the budget isn't cached");
+
+        ImpulseResponseCache cache(3 * entrySize);
+        cache.insert(makeKey(1), makeImpulseResponse(entryLength));
+        cache.insert(makeKey(2), makeImpulseResponse(4 * entryLength));
+
+        expect(cache.get(makeKey(2)) == nullptr);
+        expect(cache.get(makeKey(1)) != nullptr, "nothing should have been evicted to make room for it");
+        expectEquals(cache.getCurrentSize(), entrySize);
+    }
+
+    void testSharedBudget()
+    {
+        beginTest("IRs and spectra share one budget");
+
+        PartitionedConvolver engine;
+        engine.prepare({ 48000.0, 256, 2 });
+
+        juce::AudioBuffer<float> ir(2, 4800);
+        ir.clear();
+        ir.setSample(0, 0, 1.0f);
+        ir.setSample(1, 0, 1.0f);
+        engine.loadImpulseResponse(ir, 48000.0, false);
+
+        const auto spectra = engine.getSpectra();
+        const ImpulseResponseCache::SpectraKey spectraKey(2.5f, false, 48000.0, 1, false, 1, false, false, false, -96.0f);
+
+        // room for the spectra and one IR.
+        ImpulseResponseCache cache(spectra->getSizeInBytes() + entrySize);
+        cache.insert(makeKey(1), makeImpulseResponse(entryLength));
+        cache.insertSpectra(spectraKey, spectra);
+        expectEquals(cache.getCurrentSize(), spectra->getSizeInBytes() + entrySize);
+
+        // a second IR pushes out the first, which was used longest ago...
+        cache.insert(makeKey(2), makeImpulseResponse(entryLength));
+        expect(cache.get(makeKey(1)) == nullptr);
+        expect(cache.getSpectra(spectraKey) == spectra);
+
+        // ...and once the spectra are the oldest, an IR pushes them out too.
+        expect(cache.get(makeKey(2)) != nullptr);
+        cache.insert(makeKey(3), makeImpulseResponse(entryLength));
+        expect(cache.getSpectra(spectraKey) == nullptr);
+        expect(cache.get(makeKey(2)) != nullptr && cache.get(makeKey(3)) != nullptr);
+        expectEquals(cache.getCurrentSize(), 2 * entrySize);
+    }
+};
+
+static ImpulseResponseCacheTests impulseResponseCacheTests;
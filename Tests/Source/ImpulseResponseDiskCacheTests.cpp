@@ -0,0 +1,207 @@
+/*
+  ==============================================================================
+    ImpulseResponseDiskCacheTests.cpp
+    Created: 17 Oct 2026
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/ImpulseResponseDiskCache.h"
+
+namespace
+{
+    // a noise IR, small enough that a test can write a few of them without noticing.
+    PreparedImpulseResponse makeImpulseResponse(int numChannels, int numSamples, juce::int64 seed)
+    {
+        juce::Random random(seed);
+
+        PreparedImpulseResponse impulseResponse;
+        impulseResponse.buffer.setSize(numChannels, numSamples);
+        impulseResponse.sampleRate = 12000.0;
+
+        for (int c = 0; c < numChannels; ++c)
+            for (int i = 0; i < numSamples; ++i)
+                impulseResponse.buffer.setSample(c, i, random.nextFloat() - 0.5f);
+
+        return impulseResponse;
+    }
+
+    juce::File createTemporaryDirectory()
+    {
+        auto directory = juce::File::getSpecialLocation(juce::File::tempDirectory)
+                             .getNonexistentChildFile("SilkGhostDiskCacheTests", {}, false);
+        directory.createDirectory();
+        return directory;
+    }
+
+    juce::Array<juce::File> getCacheFiles(const juce::File& directory)
+    {
+        return directory.findChildFiles(juce::File::findFiles, false, "*.sgir");
+    }
+
+    bool isSameImpulseResponse(const PreparedImpulseResponse& a, const PreparedImpulseResponse& b)
+    {
+        if (a.buffer.getNumChannels() != b.buffer.getNumChannels() || a.buffer.getNumSamples() != b.buffer.getNumSamples()
+            || a.sampleRate != b.sampleRate)
+            return false;
+
+        for (int c = 0; c < a.buffer.getNumChannels(); ++c)
+            if (! std::equal(a.buffer.getReadPointer(c), a.buffer.getReadPointer(c) + a.buffer.getNumSamples(), b.buffer.getReadPointer(c)))
+                return false;
+
+        return true;
+    }
+}
+
+// writes real files into a temporary directory: a round trip, every kind of file the cache has
+// to refuse (each of which should be deleted as well as missed), and trimming.
+class ImpulseResponseDiskCacheTests : public juce::UnitTest
+{
+public:
+    ImpulseResponseDiskCacheTests() : juce::UnitTest("ImpulseResponseDiskCache", "SilkGhost") {}
+
+    void runTest() override
+    {
+        testRoundTrip();
+        testInvalidFiles();
+        testKeyMismatch();
+        testTrimming();
+    }
+
+private:
+    static constexpr int numSamples = 1000;
+
+    // a whole file, with its 64-byte header.
+    static constexpr juce::int64 entrySize = 64 + 2 * numSamples * (juce::int64) sizeof(float);
+
+    static ImpulseResponseCache::Key makeKey(juce::uint32 seed)
+    {
+        return { 2.5f, false, 48000.0, 1, seed, false, -96.0f };
+    }
+
+    void testRoundTrip()
+    {
+        beginTest("Loads back what it stored");
+
+        const auto directory = createTemporaryDirectory();
+        {
+            ImpulseResponseDiskCache cache(directory, ImpulseResponseDiskCache::defaultMaximumSizeInBytes);
+            const auto stored = makeImpulseResponse(2, numSamples, 1);
+
+            expect(cache.load(makeKey(1)) == nullptr);
+            expect(cache.store(makeKey(1), stored));
+            expectEquals(getCacheFiles(directory).size(), 1);
+
+            const auto loaded = cache.load(makeKey(1));
+            expect(loaded != nullptr && isSameImpulseResponse(*loaded, stored));
+            expect(cache.load(makeKey(2)) == nullptr, "another key");
+
+            cache.setEnabled(false);
+            expect(cache.load(makeKey(1)) == nullptr, "disabled");
+        }
+
+        directory.deleteRecursively();
+    }
+
+    void testInvalidFiles()
+    {
+        // offsets into the header, which is part of the file format.
+        constexpr size_t formatVersionOffset = 4, contentVersionOffset = 8;
+
+        const std::pair<const char*, std::function<void(juce::MemoryBlock&)>> corruptions[] = {
+            { "bad magic",           [](juce::MemoryBlock& data) { data[0] = 'X'; } },
+            { "bad format version",  [&](juce::MemoryBlock& data) { ++data[formatVersionOffset]; } },
+            { "bad content version", [&](juce::MemoryBlock& data) { ++data[contentVersionOffset]; } },
+            { "truncated header",    [](juce::MemoryBlock& data) { data.setSize(32); } },
+            { "truncated payload",   [](juce::MemoryBlock& data) { data.setSize(data.getSize() - sizeof(float)); } },
+            { "bad checksum",        [](juce::MemoryBlock& data) { data[data.getSize() / 2] ^= 1; } }
+        };
+
+        for (const auto& [name, corrupt] : corruptions)
+        {
+            beginTest(juce::String("Refuses and deletes a file with a ") + name);
+
+            const auto directory = createTemporaryDirectory();
+            {
+                ImpulseResponseDiskCache cache(directory, ImpulseResponseDiskCache::defaultMaximumSizeInBytes);
+                expect(cache.store(makeKey(1), makeImpulseResponse(2, numSamples, 1)));
+
+                const auto file = getCacheFiles(directory)[0];
+                juce::MemoryBlock data;
+                file.loadFileAsData(data);
+                corrupt(data);
+                file.replaceWithData(data.getData(), data.getSize());
+
+                expect(cache.load(makeKey(1)) == nullptr);
+                expect(! file.exists(), "the file should have gone");
+            }
+
+            directory.deleteRecursively();
+        }
+    }
+
+    void testKeyMismatch()
+    {
+        beginTest("Refuses and deletes a file written for another key");
+
+        const auto directory = createTemporaryDirectory();
+        {
+            ImpulseResponseDiskCache cache(directory, ImpulseResponseDiskCache::defaultMaximumSizeInBytes);
+
+            // a perfectly good file, just under another key's name.
+            expect(cache.store(makeKey(2), makeImpulseResponse(2, numSamples, 2)));
+            const auto otherFile = getCacheFiles(directory)[0];
+
+            expect(cache.store(makeKey(1), makeImpulseResponse(2, numSamples, 1)));
+            auto file = getCacheFiles(directory)[0];
+            if (file == otherFile)
+                file = getCacheFiles(directory)[1];
+
+            expect(otherFile.copyFileTo(file));
+            expect(cache.load(makeKey(1)) == nullptr);
+            expect(! file.exists(), "the file should have gone");
+            expect(cache.load(makeKey(2)) != nullptr, "the other key's own file should still load");
+        }
+
+        directory.deleteRecursively();
+    }
+
+    void testTrimming()
+    {
+        beginTest("Trimming throws out the least recently used files first");
+
+        const auto directory = createTemporaryDirectory();
+        {
+            ImpulseResponseDiskCache cache(directory, ImpulseResponseDiskCache::defaultMaximumSizeInBytes);
+
+            // three files, each an hour older than the next.
+            juce::File files[3];
+            for (juce::uint32 seed = 0; seed < 3; ++seed)
+            {
+                expect(cache.store(makeKey(seed), makeImpulseResponse(2, numSamples, seed)));
+
+                for (auto& f : getCacheFiles(directory))
+                    if (std::find(std::begin(files), std::end(files), f) == std::end(files))
+                        files[seed] = f;
+
+                files[seed].setLastModificationTime(juce::Time::getCurrentTime() - juce::RelativeTime::hours(3 - (int) seed));
+            }
+
+            expectEquals(getCacheFiles(directory).size(), 3);
+
+            // room for two: the oldest goes.
+            cache.setMaximumSize(2 * entrySize);
+            expect(! files[0].exists() && files[1].exists() && files[2].exists(), "shrinking the cap");
+
+            // a load counts as a use, so storing another now throws out the one that wasn't loaded.
+            expect(cache.load(makeKey(1)) != nullptr);
+            expect(cache.store(makeKey(3), makeImpulseResponse(2, numSamples, 3)));
+            expect(files[1].exists() && ! files[2].exists(), "storing past the cap");
+            expectEquals(getCacheFiles(directory).size(), 2);
+        }
+
+        directory.deleteRecursively();
+    }
+};
+
+static ImpulseResponseDiskCacheTests impulseResponseDiskCacheTests;
@@ -0,0 +1,190 @@
+/*
+  ==============================================================================
+    ImpulseResponseSynthesisTests.cpp
+    Created: 17 Oct 2026
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/ImpulseResponseSynthesis.h"
+
+namespace
+{
+    using ImpulseResponseSynthesis::Instructions;
+
+    // the kernels go up in width, and every one up to the best this machine has can run.
+    std::vector<Instructions> getAvailableInstructions()
+    {
+        std::vector<Instructions> available;
+        for (auto instructions : { Instructions::scalar, Instructions::sse2, Instructions::avx2 })
+            if (instructions <= ImpulseResponseSynthesis::getBestAvailableInstructions())
+                available.push_back(instructions);
+
+        return available;
+    }
+
+    const char* getName(Instructions instructions)
+    {
+        switch (instructions)
+        {
+            case Instructions::scalar:  return "scalar";
+            case Instructions::sse2:    return "SSE2";
+            case Instructions::avx2:    return "AVX2";
+        }
+
+        return "unknown";
+    }
+}
+
+// every late tail kernel this machine can run, against the scalar one -- they do the same
+// arithmetic in the same order, so they should agree to the bit. and the same goes for the
+// tail rendered in parallel, however many threads it gets.
+class ImpulseResponseSynthesisTests : public juce::UnitTest
+{
+public:
+    ImpulseResponseSynthesisTests() : juce::UnitTest("ImpulseResponseSynthesis", "SilkGhost") {}
+
+    void runTest() override
+    {
+        testKernels();
+        testThreadCount();
+    }
+
+private:
+    void testKernels()
+    {
+        ImpulseResponseSynthesis::LateTailParameters forward, undecayed;
+        forward.sampleRate = 48000.0;
+        forward.decayTime = 2.0f;
+        undecayed.sampleRate = 96000.0;
+        undecayed.decayTime = 0.0f;
+
+        for (auto instructions : getAvailableInstructions())
+        {
+            if (instructions == Instructions::scalar)
+                continue;
+
+            beginTest(juce::String(getName(instructions)) + " matches scalar");
+
+            // slices that start off a lane boundary and end part-way through a chunk, as well
+            // as whole chunks, both ways round.
+            const std::pair<int, int> slices[] = { { 0, 1 }, { 0, 1024 }, { 5, 7 }, { 13, 3000 }, { 123457, 65536 } };
+
+            for (const auto* parameters : { &forward, &undecayed })
+            {
+                for (bool reversed : { false, true })
+                {
+                    for (auto [start, numSamples] : slices)
+                    {
+                        std::vector<float> expected((size_t) numSamples), actual((size_t) numSamples);
+                        const auto expectedPeak = ImpulseResponseSynthesis::renderLateTail(expected.data(), start, numSamples, *parameters, 7,
+                                                                                           reversed, Instructions::scalar);
+                        const auto actualPeak = ImpulseResponseSynthesis::renderLateTail(actual.data(), start, numSamples, *parameters, 7,
+                                                                                         reversed, instructions);
+
+                        const auto name = juce::String(numSamples) + " samples from " + juce::String(start) + (reversed ? ", reversed" : "");
+                        expect(actual == expected, name);
+                        expectEquals(actualPeak, expectedPeak, name);
+                    }
+                }
+            }
+        }
+    }
+
+    void testThreadCount()
+    {
+        beginTest("Thread count doesn't change the tail");
+
+        ImpulseResponseSynthesis::LateTailParameters parameters;
+        parameters.sampleRate = 48000.0;
+        parameters.decayTime = 20.0f;
+
+        ImpulseResponseSynthesis::WorkerPool oneThread(1), manyThreads(juce::jmax(4, juce::SystemStats::getNumCpus()));
+
+        // a 20s IR, with the tail starting where the processor's does.
+        for (bool reversed : { false, true })
+        {
+            juce::AudioBuffer<float> expected(2, (int) (parameters.sampleRate * 20.0)), actual(2, expected.getNumSamples());
+            expected.clear();
+            actual.clear();
+
+            const auto expectedPeak = ImpulseResponseSynthesis::renderLateTailParallel(oneThread, expected, 4800, parameters, 3,
+                                                                                       reversed, nullptr);
+            const auto actualPeak = ImpulseResponseSynthesis::renderLateTailParallel(manyThreads, actual, 4800, parameters, 3,
+                                                                                     reversed, nullptr);
+
+            bool identical = true;
+            for (int c = 0; c < expected.getNumChannels(); ++c)
+                identical = identical && std::equal(expected.getReadPointer(c), expected.getReadPointer(c) + expected.getNumSamples(),
+                                                    actual.getReadPointer(c));
+
+            expect(identical, reversed ? "reversed" : "forward");
+            expect(expectedPeak.has_value() && actualPeak.has_value() && *expectedPeak == *actualPeak);
+        }
+    }
+};
+
+// the worst case the synthesis has to cope with -- 20s of stereo at 192kHz -- rendered on one
+// thread by each kernel, and then across a pool, as the best of a few runs. only runs when asked
+// for (see Main.cpp).
+class ImpulseResponseSynthesisBenchmark : public juce::UnitTest
+{
+public:
+    ImpulseResponseSynthesisBenchmark() : juce::UnitTest("ImpulseResponseSynthesis benchmark", "SilkGhost benchmarks") {}
+
+    void runTest() override
+    {
+        beginTest("Late tail, 20s of stereo at 192kHz");
+
+        ImpulseResponseSynthesis::LateTailParameters parameters;
+        parameters.sampleRate = 192000.0;
+        parameters.decayTime = 20.0f;
+
+        juce::AudioBuffer<float> tail(2, (int) (parameters.sampleRate * 20.0));
+        double scalarTime = 0.0;
+
+        for (auto instructions : getAvailableInstructions())
+        {
+            double best = std::numeric_limits<double>::max();
+
+            for (int run = 0; run < 5; ++run)
+            {
+                const auto start = juce::Time::getMillisecondCounterHiRes();
+
+                for (int c = 0; c < tail.getNumChannels(); ++c)
+                    ImpulseResponseSynthesis::renderLateTail(tail.getWritePointer(c), 0, tail.getNumSamples(), parameters,
+                                                             (juce::uint32) c, false, instructions);
+
+                best = juce::jmin(best, juce::Time::getMillisecondCounterHiRes() - start);
+            }
+
+            if (instructions == Instructions::scalar)
+                scalarTime = best;
+
+            logMessage(juce::String(getName(instructions)) + ": " + juce::String(best, 1) + " ms ("
+                       + juce::String(scalarTime / best, 1) + "x scalar)");
+        }
+
+        // and the same again the way an IR build does it, cut into slices and spread across a
+        // pool. the target is a few milliseconds with every core on it.
+        beginTest("Parallel late tail, 20s of stereo at 192kHz");
+
+        for (int numThreads : { 1, juce::SystemStats::getNumCpus() })
+        {
+            ImpulseResponseSynthesis::WorkerPool workers(numThreads);
+            double best = std::numeric_limits<double>::max();
+
+            for (int run = 0; run < 5; ++run)
+            {
+                const auto start = juce::Time::getMillisecondCounterHiRes();
+                ImpulseResponseSynthesis::renderLateTailParallel(workers, tail, 0, parameters, 0, false, nullptr);
+                best = juce::jmin(best, juce::Time::getMillisecondCounterHiRes() - start);
+            }
+
+            logMessage(juce::String(numThreads) + (numThreads == 1 ? " thread: " : " threads: ") + juce::String(best, 1) + " ms");
+        }
+    }
+};
+
+static ImpulseResponseSynthesisTests impulseResponseSynthesisTests;
+static ImpulseResponseSynthesisBenchmark impulseResponseSynthesisBenchmark;
@@ -0,0 +1,25 @@
+/*
+  ==============================================================================
+    Main.cpp
+    Created: 17 Oct 2026
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+
+// runs every SilkGhost test, and returns non-zero if any of them failed -- so it can sit in a
+// build script as it is. with --benchmark, it runs the benchmarks instead, which only report.
+int main(int argc, char* argv[])
+{
+    const bool benchmark = argc > 1 && juce::String(argv[1]) == "--benchmark";
+
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+    runner.runTestsInCategory(benchmark ? "SilkGhost benchmarks" : "SilkGhost");
+
+    int failures = 0;
+    for (int i = 0; i < runner.getNumResults(); ++i)
+        failures += runner.getResult(i)->failures;
+
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,651 @@
+/*
+  ==============================================================================
+    PartitionedConvolverTests.cpp
+    Created: 17 Oct 2026
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/PartitionedConvolver.h"
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+
+    // noise with an exponential decay on it (or none, for a decay of zero). it's seeded, so every
+    // run gets the same signals.
+    juce::AudioBuffer<float> makeNoise(int numChannels, int numSamples, juce::int64 seed, float decaySamples = 0.0f)
+    {
+        juce::Random random(seed);
+        juce::AudioBuffer<float> buffer(numChannels, numSamples);
+
+        for (int c = 0; c < numChannels; ++c)
+            for (int i = 0; i < numSamples; ++i)
+                buffer.setSample(c, i, (random.nextFloat() - 0.5f) * (decaySamples > 0.0f ? std::exp(-i / decaySamples) : 1.0f));
+
+        return buffer;
+    }
+
+    // a burst of noise followed by enough silence for the whole tail to come out.
+    juce::AudioBuffer<float> makeInput(int numChannels, int burstLength, int numSamples, juce::int64 seed)
+    {
+        auto input = makeNoise(numChannels, numSamples, seed);
+        for (int c = 0; c < numChannels; ++c)
+            input.clear(c, burstLength, numSamples - burstLength);
+
+        return input;
+    }
+
+    // runs part of the buffer through the engine in place, the way a host would: in blocks that
+    // change size every time (up to maximumBlockSize), so the stages never line up with the calls
+    // the same way twice.
+    void processRange(PartitionedConvolver& engine, juce::AudioBuffer<float>& buffer, int maximumBlockSize, int start, int end)
+    {
+        juce::dsp::AudioBlock<float> block(buffer);
+
+        for (int call = 0; start < end; ++call)
+        {
+            const int numSamples = juce::jmin(end - start, 1 + (call * 37) % maximumBlockSize);
+            auto subBlock = block.getSubBlock((size_t) start, (size_t) numSamples);
+            engine.process(juce::dsp::ProcessContextReplacing<float>(subBlock));
+            start += numSamples;
+        }
+    }
+
+    juce::AudioBuffer<float> process(PartitionedConvolver& engine, const juce::AudioBuffer<float>& input, int maximumBlockSize)
+    {
+        juce::AudioBuffer<float> output;
+        output.makeCopyOf(input);
+        processRange(engine, output, maximumBlockSize, 0, output.getNumSamples());
+        return output;
+    }
+
+    // the textbook sum, in double precision: slow, but there's nothing in it to get wrong. only
+    // the first burstLength samples of the input are read, as the rest is silent anyway.
+    std::vector<double> convolveDirectly(const float* input, int burstLength, const float* impulseResponse, int impulseResponseLength,
+                                         int numSamples)
+    {
+        std::vector<double> output((size_t) numSamples, 0.0);
+
+        for (int m = 0; m < burstLength; ++m)
+            for (int k = 0; k < impulseResponseLength && m + k < numSamples; ++k)
+                output[(size_t) (m + k)] += (double) input[m] * impulseResponse[k];
+
+        return output;
+    }
+
+    // the biggest difference between the engine's output (which is late by its latency) and the
+    // reference, as a fraction of the reference's peak.
+    double getRelativeError(const juce::AudioBuffer<float>& output, int channel, int latency, const std::vector<double>& reference)
+    {
+        double error = 0.0, peak = 0.0;
+
+        for (int n = 0; n + latency < output.getNumSamples() && n < (int) reference.size(); ++n)
+        {
+            error = juce::jmax(error, std::abs(output.getSample(channel, n + latency) - reference[(size_t) n]));
+            peak = juce::jmax(peak, std::abs(reference[(size_t) n]));
+        }
+
+        return error / peak;
+    }
+
+    // the biggest difference between two outputs, which should be exactly the same.
+    float getMaximumDifference(const juce::AudioBuffer<float>& a, const juce::AudioBuffer<float>& b)
+    {
+        float difference = 0.0f;
+
+        for (int c = 0; c < a.getNumChannels(); ++c)
+            for (int i = 0; i < a.getNumSamples(); ++i)
+                difference = juce::jmax(difference, std::abs(a.getSample(c, i) - b.getSample(c, i)));
+
+        return difference;
+    }
+
+    std::unique_ptr<PartitionedConvolver> createEngine(const PartitionedConvolver::Scheme& scheme, int maximumBlockSize)
+    {
+        auto engine = std::make_unique<PartitionedConvolver>(scheme);
+        engine->prepare({ sampleRate, (juce::uint32) maximumBlockSize, 2 });
+        return engine;
+    }
+}
+
+// checks the engine against plain direct convolution, across its schemes and layouts, and
+// checks that loading it in pieces (deferred, or from cached spectra) changes nothing at all.
+class PartitionedConvolverTests : public juce::UnitTest
+{
+public:
+    PartitionedConvolverTests() : juce::UnitTest("PartitionedConvolver", "SilkGhost") {}
+
+    void runTest() override
+    {
+        testSchemes();
+        testTrueStereo();
+        testLayouts();
+        testReflections();
+        testFeedbackTail();
+        testQuietPartitions();
+        testSplitBands();
+        testDeferredLoading();
+        testSpectraReuse();
+    }
+
+private:
+    // about -100dB: the same as an FFT convolution in single precision gets anywhere.
+    static constexpr double tolerance = 1.0e-5;
+
+    static constexpr int impulseResponseLength = 30000;
+    static constexpr int burstLength = 2000;
+    static constexpr int numSamples = impulseResponseLength + burstLength + 1000;
+
+    void testSchemes()
+    {
+        beginTest("Matches direct convolution across schemes and block sizes");
+
+        const auto ir = makeNoise(2, impulseResponseLength, 1, 8000.0f);
+        const auto input = makeInput(2, burstLength, numSamples, 2);
+
+        std::vector<double> references[2];
+        for (int c = 0; c < 2; ++c)
+            references[c] = convolveDirectly(input.getReadPointer(c), burstLength, ir.getReadPointer(c), impulseResponseLength, numSamples);
+
+        PartitionedConvolver::Scheme zeroLatency, small, singleThreaded;
+        zeroLatency.zeroLatency = true;
+        small.headBlockSize = 64;
+        small.growthFactor = 2;
+        small.partitionsPerStage = 2;
+        small.maximumBlockSize = 1024;
+        singleThreaded.useWorkerThreads = false;
+
+        const std::pair<const char*, PartitionedConvolver::Scheme> schemes[] = {
+            { "default", {} }, { "zero latency", zeroLatency }, { "small partitions", small }, { "no workers", singleThreaded }
+        };
+
+        for (const auto& [name, scheme] : schemes)
+        {
+            for (int maximumBlockSize : { 64, 256, 1000 })
+            {
+                auto engine = createEngine(scheme, maximumBlockSize);
+                engine->loadImpulseResponse(ir, sampleRate, false);
+                const auto output = process(*engine, input, maximumBlockSize);
+
+                for (int c = 0; c < 2; ++c)
+                    expectLessThan(getRelativeError(output, c, engine->getLatency(), references[c]), tolerance,
+                                   juce::String(name) + ", blocks of up to " + juce::String(maximumBlockSize));
+            }
+        }
+    }
+
+    void testTrueStereo()
+    {
+        beginTest("True stereo feeds each input to both outputs");
+
+        // LL, LR, RL, RR.
+        const auto ir = makeNoise(4, impulseResponseLength, 3, 8000.0f);
+        const auto input = makeInput(2, burstLength, numSamples, 4);
+
+        auto engine = createEngine({}, 256);
+        engine->loadImpulseResponse(ir, sampleRate, false);
+        expect(engine->isTrueStereo());
+
+        const auto output = process(*engine, input, 256);
+
+        for (int out = 0; out < 2; ++out)
+        {
+            std::vector<double> reference((size_t) numSamples, 0.0);
+            for (int in = 0; in < 2; ++in)
+            {
+                const auto path = convolveDirectly(input.getReadPointer(in), burstLength, ir.getReadPointer(in * 2 + out),
+                                                   impulseResponseLength, numSamples);
+                for (size_t i = 0; i < reference.size(); ++i)
+                    reference[i] += path[i];
+            }
+
+            expectLessThan(getRelativeError(output, out, engine->getLatency(), reference), tolerance);
+        }
+    }
+
+    void testLayouts()
+    {
+        beginTest("Layouts match the IR they describe");
+
+        const auto ir = makeNoise(2, impulseResponseLength, 5, 8000.0f);
+        const auto input = makeInput(2, burstLength, numSamples, 6);
+
+        // all on head block boundaries, so nothing gets moved.
+        constexpr int decayStart = 3072, lateStart = 6144, end = 24000;
+        PartitionedConvolver::Layout layout;
+        layout.decayStart = decayStart / sampleRate;
+        layout.lateStart = lateStart / sampleRate;
+        layout.end = end / sampleRate;
+
+        // the IR with the layout's end, and a gain on each part, applied to it directly. a decay
+        // time puts the envelope on everything from the decay start on, and this one's long
+        // enough that no partitions get dropped for being past its -60dB point.
+        auto expectMatches = [&](float earlyGain, float lateGain, float decayTime, double allowedError, const juce::String& name)
+        {
+            auto engine = createEngine({}, 256);
+            engine->loadImpulseResponse(ir, sampleRate, false, layout);
+            engine->setEarlyLateGains(earlyGain, lateGain);
+            engine->setDecayTime(decayTime);
+            const auto output = process(*engine, input, 256);
+
+            expectEquals(engine->getImpulseResponseLength(), end);
+
+            for (int c = 0; c < 2; ++c)
+            {
+                std::vector<float> expected(ir.getReadPointer(c), ir.getReadPointer(c) + end);
+                for (int i = 0; i < end; ++i)
+                {
+                    expected[(size_t) i] *= i < lateStart ? earlyGain : lateGain;
+                    if (decayTime > 0.0f && i >= decayStart)
+                        expected[(size_t) i] *= (float) std::exp(-6.91 * i / (decayTime * sampleRate));
+                }
+
+                const auto reference = convolveDirectly(input.getReadPointer(c), burstLength, expected.data(), end, numSamples);
+                expectLessThan(getRelativeError(output, c, engine->getLatency(), reference), allowedError, name);
+            }
+        };
+
+        expectMatches(1.0f, 1.0f, 0.0f, tolerance, "as loaded");
+        expectMatches(0.5f, 2.0f, 0.0f, tolerance, "early and late gains");
+
+        // the decay is scaled a partition at a time, with a straight line across each one, so
+        // it's only close (-60dB, where it's nearer -75dB in practice) rather than exact.
+        expectMatches(1.0f, 1.0f, 1.0f, 1.0e-3, "decay time");
+    }
+
+    void testReflections()
+    {
+        beginTest("Reflection taps match the same reflections baked into the IR");
+
+        // the IR is silent where the reflections go, the way it is when they've been taken out of it.
+        constexpr int reflectionsEnd = 2400, lateStart = 6144, numTaps = 8;
+        auto ir = makeNoise(2, impulseResponseLength, 14, 8000.0f);
+        for (int c = 0; c < 2; ++c)
+            ir.clear(c, 0, reflectionsEnd);
+
+        const auto input = makeInput(2, burstLength, numSamples, 15);
+
+        PartitionedConvolver::Layout layout;
+        layout.lateStart = lateStart / sampleRate;
+        layout.reflections.gains.setSize(2, numTaps);
+
+        // the same IR with the reflections put back in as impulses.
+        juce::AudioBuffer<float> baked;
+        baked.makeCopyOf(ir);
+        juce::Random random(16);
+
+        for (int t = 0; t < numTaps; ++t)
+        {
+            const int time = 97 + t * 263;
+            layout.reflections.times.push_back(time / sampleRate);
+
+            for (int c = 0; c < 2; ++c)
+            {
+                const auto gain = (random.nextFloat() - 0.5f) * 2.0f;
+                layout.reflections.gains.setSample(c, t, gain);
+                baked.setSample(c, time, gain);
+            }
+        }
+
+        PartitionedConvolver::Scheme zeroLatency;
+        zeroLatency.zeroLatency = true;
+
+        const std::pair<juce::String, PartitionedConvolver::Scheme> schemes[] = { { "default", {} }, { "zero latency", zeroLatency } };
+
+        for (const auto& [name, scheme] : schemes)
+        {
+            // with the early gain on the taps as well as the early part of the IR.
+            {
+                auto engine = createEngine(scheme, 256);
+                engine->loadImpulseResponse(ir, sampleRate, false, layout);
+                engine->setEarlyLateGains(0.5f, 2.0f);
+                const auto output = process(*engine, input, 256);
+
+                for (int c = 0; c < 2; ++c)
+                {
+                    std::vector<float> expected(baked.getReadPointer(c), baked.getReadPointer(c) + impulseResponseLength);
+                    for (int i = 0; i < impulseResponseLength; ++i)
+                        expected[(size_t) i] *= i < lateStart ? 0.5f : 2.0f;
+
+                    const auto reference = convolveDirectly(input.getReadPointer(c), burstLength, expected.data(),
+                                                            impulseResponseLength, numSamples);
+                    expectLessThan(getRelativeError(output, c, engine->getLatency(), reference), tolerance, name + ", early and late gains");
+                }
+            }
+
+            // and normalised, where the taps have to count towards the level just as they would in the IR.
+            {
+                auto withTaps = createEngine(scheme, 256);
+                withTaps->loadImpulseResponse(ir, sampleRate, true, layout);
+
+                auto withoutTaps = createEngine(scheme, 256);
+                PartitionedConvolver::Layout bakedLayout;
+                bakedLayout.lateStart = layout.lateStart;
+                withoutTaps->loadImpulseResponse(baked, sampleRate, true, bakedLayout);
+
+                const auto output = process(*withTaps, input, 256);
+                const auto reference = process(*withoutTaps, input, 256);
+
+                for (int c = 0; c < 2; ++c)
+                {
+                    const std::vector<double> referenceChannel(reference.getReadPointer(c), reference.getReadPointer(c) + numSamples);
+                    expectLessThan(getRelativeError(output, c, 0, referenceChannel), tolerance, name + ", normalised");
+                }
+            }
+        }
+    }
+
+    void testFeedbackTail()
+    {
+        beginTest("A feedback tail takes over at the same level as the convolved tail");
+
+        // undecayed noise, with the decay left to setDecayTime(), the way the processor loads it.
+        constexpr int decayStart = 2432, feedbackStart = 14400, windowLength = 2400;
+        const auto ir = makeNoise(2, (int) sampleRate * 2, 17);
+
+        PartitionedConvolver::Layout layout;
+        layout.decayStart = decayStart / sampleRate;
+
+        auto hybridLayout = layout;
+        hybridLayout.feedbackStart = feedbackStart / sampleRate;
+
+        // an impulse on each channel, so the output is the engine's own response.
+        juce::AudioBuffer<float> input(2, (int) sampleRate * 3 / 2);
+        input.clear();
+        input.setSample(0, 0, 1.0f);
+        input.setSample(1, 0, 1.0f);
+
+        for (float decayTime : { 1.0f, 2.0f })
+        {
+            auto convolved = createEngine({}, 256);
+            convolved->loadImpulseResponse(ir, sampleRate, false, layout);
+            convolved->setDecayTime(decayTime);
+
+            auto hybrid = createEngine({}, 256);
+            hybrid->loadImpulseResponse(ir, sampleRate, false, hybridLayout);
+            hybrid->setDecayTime(decayTime);
+            expect(hybrid->hasFeedbackTail());
+
+            const auto expected = process(*convolved, input, 256);
+            const auto actual = process(*hybrid, input, 256);
+            const int latency = hybrid->getLatency();
+            const auto name = "decay time of " + juce::String(decayTime, 1) + "s";
+
+            for (int c = 0; c < 2; ++c)
+            {
+                // up to the feedback start, it's the same IR.
+                double error = 0.0, peak = 0.0;
+                for (int n = latency; n < latency + feedbackStart; ++n)
+                {
+                    error = juce::jmax(error, (double) std::abs(actual.getSample(c, n) - expected.getSample(c, n)));
+                    peak = juce::jmax(peak, (double) std::abs(expected.getSample(c, n)));
+                }
+
+                expectLessThan(error / peak, tolerance, name + ", before the feedback start");
+
+                // from there on it's different noise, so only its level can match -- through the
+                // crossfade and on down to 40dB under, past which the windows are too short to
+                // say much about it.
+                const auto duration = juce::jmin(input.getNumSamples() - latency, (int) (decayTime * sampleRate * 40.0 / 60.0));
+                float worst = 0.0f;
+
+                for (int start = feedbackStart; start + windowLength <= duration; start += windowLength)
+                {
+                    double actualEnergy = 0.0, expectedEnergy = 0.0;
+                    for (int n = latency + start; n < latency + start + windowLength; ++n)
+                    {
+                        actualEnergy += std::pow(actual.getSample(c, n), 2.0);
+                        expectedEnergy += std::pow(expected.getSample(c, n), 2.0);
+                    }
+
+                    worst = juce::jmax(worst, std::abs((float) (10.0 * std::log10(actualEnergy / expectedEnergy))));
+                }
+
+                expectLessThan(worst, 1.5f, name + ", level after the feedback start (dB)");
+            }
+        }
+    }
+
+    void testQuietPartitions()
+    {
+        beginTest("Skipping quiet partitions stays within its budget");
+
+        // a reversed IR, which rises out of near silence -- so its first partitions are quiet,
+        // but none of them are silent.
+        auto ir = makeNoise(2, impulseResponseLength, 18, 4000.0f);
+        for (int c = 0; c < 2; ++c)
+            std::reverse(ir.getWritePointer(c), ir.getWritePointer(c) + impulseResponseLength);
+
+        const auto input = makeInput(2, burstLength, numSamples, 19);
+
+        std::vector<double> references[2];
+        for (int c = 0; c < 2; ++c)
+            references[c] = convolveDirectly(input.getReadPointer(c), burstLength, ir.getReadPointer(c), impulseResponseLength, numSamples);
+
+        int lastActive = 0;
+
+        // from nothing skipped at all to more and more, by the budget.
+        for (float skipDecibels : { -300.0f, -70.0f, -50.0f, -30.0f })
+        {
+            PartitionedConvolver::Scheme scheme;
+            scheme.partitionSkipDecibels = skipDecibels;
+
+            auto engine = createEngine(scheme, 256);
+            engine->loadImpulseResponse(ir, sampleRate, false);
+            const auto output = process(*engine, input, 256);
+            const auto name = juce::String(skipDecibels, 0) + "dB";
+
+            const int active = engine->getNumActivePartitions();
+            if (skipDecibels < -200.0f)
+                expectEquals(active, engine->getNumPartitions(), name + ": none should be skipped");
+            else
+                expect(active < lastActive, name + ": more should be skipped");
+
+            lastActive = active;
+
+            // the input's noise, so what's left out of the output is about what's left out of
+            // the IR. a little over the budget is allowed for, as the burst is only so long.
+            for (int c = 0; c < 2; ++c)
+            {
+                double error = 0.0, energy = 0.0;
+                for (int n = 0; n + engine->getLatency() < numSamples; ++n)
+                {
+                    error += std::pow(output.getSample(c, n + engine->getLatency()) - references[c][(size_t) n], 2.0);
+                    energy += std::pow(references[c][(size_t) n], 2.0);
+                }
+
+                expectLessThan((float) (10.0 * std::log10(error / energy)), juce::jmax(skipDecibels, -90.0f) + 1.0f, name + " (dB)");
+            }
+        }
+    }
+
+    void testSplitBands()
+    {
+        beginTest("Split bands add back up to the full band");
+
+        // with a delta for each band's IR, the two bands together should be a plain delay.
+        juce::AudioBuffer<float> low(2, 64), high(2, 64);
+        low.clear();
+        high.clear();
+        for (int c = 0; c < 2; ++c)
+        {
+            low.setSample(c, 0, 1.0f);
+            high.setSample(c, 0, 1.0f);
+        }
+
+        for (int decimation : { 2, 4 })
+        {
+            PartitionedConvolver::Scheme scheme;
+            scheme.decimation = decimation;
+            scheme.splitBands = true;
+
+            auto engine = createEngine(scheme, 256);
+            engine->loadImpulseResponse(low, sampleRate / decimation, false);
+            engine->loadHighBandImpulseResponse(high, sampleRate, {});
+
+            const auto input = makeNoise(2, 48000, 7);
+            const auto output = process(*engine, input, 256);
+            const int latency = engine->getLatency();
+
+            // past the filters' start-up.
+            double error = 0.0, energy = 0.0;
+            for (int n = latency + 2000; n < input.getNumSamples(); ++n)
+            {
+                error += std::pow(output.getSample(0, n) - input.getSample(0, n - latency), 2.0);
+                energy += std::pow(input.getSample(0, n - latency), 2.0);
+            }
+
+            expectLessThan(juce::Decibels::gainToDecibels((float) std::sqrt(error / energy)), -60.0f,
+                           "decimating by " + juce::String(decimation));
+        }
+    }
+
+    // a split-band, decimated engine with every kind of stage we have, for the tests that only
+    // compare one engine with another.
+    static PartitionedConvolver::Scheme getFullScheme()
+    {
+        PartitionedConvolver::Scheme scheme;
+        scheme.decimation = 4;
+        scheme.splitBands = true;
+        return scheme;
+    }
+
+    static PartitionedConvolver::Layout getFullLayout()
+    {
+        PartitionedConvolver::Layout layout;
+        layout.decayStart = 0.1;
+        layout.lateStart = 0.1;
+        return layout;
+    }
+
+    void testDeferredLoading()
+    {
+        beginTest("Deferred loading matches an immediate load");
+
+        const auto low = makeNoise(2, (int) (sampleRate / 4 * 4), 8);
+        const auto high = makeNoise(2, (int) sampleRate, 9);
+        const auto input = makeInput(2, 4800, (int) sampleRate * 6, 10);
+
+        auto load = [&](double deferredStart)
+        {
+            auto layout = getFullLayout();
+            layout.deferredStart = deferredStart;
+
+            auto engine = createEngine(getFullScheme(), 256);
+            engine->loadImpulseResponse(low, sampleRate / 4, true, layout);
+            engine->loadHighBandImpulseResponse(high, sampleRate, layout);
+            engine->setDecayTime(2.0f);
+            return engine;
+        };
+
+        auto immediate = load(-1.0);
+        auto deferred = load(0.3);
+
+        // the deferred stages come in after the engine's already been running for a while, and
+        // have to catch up on the input they've missed.
+        constexpr int loadedAt = 4096;
+        expect(deferred->claimDeferredStages());
+        expect(! deferred->getSpectra()->isComplete());
+
+        juce::AudioBuffer<float> output;
+        output.makeCopyOf(input);
+
+        processRange(*deferred, output, 256, 0, loadedAt);
+        deferred->loadDeferredStages();
+        expect(deferred->getSpectra()->isComplete());
+        processRange(*deferred, output, 256, loadedAt, output.getNumSamples());
+
+        const auto reference = process(*immediate, input, 256);
+
+        expectEquals(deferred->getNumPartitions(), immediate->getNumPartitions());
+        expectEquals(getMaximumDifference(output, reference), 0.0f);
+    }
+
+    void testSpectraReuse()
+    {
+        beginTest("Cached spectra match a fresh load");
+
+        const auto low = makeNoise(2, (int) (sampleRate / 4 * 4), 11);
+        const auto high = makeNoise(2, (int) sampleRate, 12);
+        const auto input = makeInput(2, 4800, (int) sampleRate * 6, 13);
+        const auto layout = getFullLayout();
+
+        auto fresh = createEngine(getFullScheme(), 256);
+        fresh->loadImpulseResponse(low, sampleRate / 4, true, layout);
+        fresh->loadHighBandImpulseResponse(high, sampleRate, layout);
+
+        const auto spectra = fresh->getSpectra();
+        expect(spectra->isComplete());
+
+        auto cached = createEngine(getFullScheme(), 256);
+        cached->loadImpulseResponse(low, sampleRate / 4, true, layout, spectra);
+        cached->loadHighBandImpulseResponse(high, sampleRate, layout, spectra);
+
+        fresh->setDecayTime(2.0f);
+        cached->setDecayTime(2.0f);
+
+        expectEquals(getMaximumDifference(process(*fresh, input, 256), process(*cached, input, 256)), 0.0f);
+    }
+};
+
+// the cost of the zero-latency head against the default scheme, at a few host block sizes, as
+// a share of one core. the worker threads are off, so all of the work is counted. only runs when
+// asked for (see Main.cpp).
+class PartitionedConvolverBenchmark : public juce::UnitTest
+{
+public:
+    PartitionedConvolverBenchmark() : juce::UnitTest("PartitionedConvolver benchmark", "SilkGhost benchmarks") {}
+
+    void runTest() override
+    {
+        beginTest("Zero latency against the default, 4s stereo IR at 48kHz");
+
+        const auto ir = makeNoise(2, (int) sampleRate * 4, 1, (float) sampleRate);
+        const auto input = makeNoise(2, (int) sampleRate * 10, 2);
+
+        PartitionedConvolver::Scheme standard, zeroLatency;
+        standard.useWorkerThreads = false;
+        zeroLatency.useWorkerThreads = false;
+        zeroLatency.zeroLatency = true;
+
+        for (int blockSize : { 64, 256, 512 })
+            logMessage(juce::String(blockSize) + "-sample blocks: default "
+                       + juce::String(measureLoad(standard, ir, input, blockSize), 1) + "%, zero latency "
+                       + juce::String(measureLoad(zeroLatency, ir, input, blockSize), 1) + "% of a core");
+    }
+
+private:
+    // runs the input through a fresh engine in fixed-size blocks, and returns the time it took as
+    // a percentage of the input's length (the best of a few runs).
+    static double measureLoad(const PartitionedConvolver::Scheme& scheme, const juce::AudioBuffer<float>& ir,
+                              const juce::AudioBuffer<float>& input, int blockSize)
+    {
+        double best = std::numeric_limits<double>::max();
+
+        for (int run = 0; run < 3; ++run)
+        {
+            auto engine = createEngine(scheme, blockSize);
+            engine->loadImpulseResponse(ir, sampleRate, false);
+
+            juce::AudioBuffer<float> buffer;
+            buffer.makeCopyOf(input);
+            juce::dsp::AudioBlock<float> block(buffer);
+
+            const auto start = juce::Time::getMillisecondCounterHiRes();
+
+            for (int i = 0; i + blockSize <= buffer.getNumSamples(); i += blockSize)
+            {
+                auto subBlock = block.getSubBlock((size_t) i, (size_t) blockSize);
+                engine->process(juce::dsp::ProcessContextReplacing<float>(subBlock));
+            }
+
+            best = juce::jmin(best, juce::Time::getMillisecondCounterHiRes() - start);
+        }
+
+        return best / 1000.0 / (input.getNumSamples() / sampleRate) * 100.0;
+    }
+};
+
+static PartitionedConvolverTests partitionedConvolverTests;
+static PartitionedConvolverBenchmark partitionedConvolverBenchmark;
@@ -0,0 +1,146 @@
+/*
+  ==============================================================================
+    SpectralKernelsTests.cpp
+    Created: 17 Oct 2026
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/SpectralKernels.h"
+
+namespace
+{
+    using SpectralKernels::Instructions;
+
+    constexpr Instructions allInstructions[] = { Instructions::scalar, Instructions::sse2, Instructions::avx2, Instructions::avx512 };
+
+    std::vector<float> makeSpectrum(int numBins, juce::Random& random)
+    {
+        std::vector<float> spectrum((size_t) numBins * 2);
+        for (auto& v : spectrum)
+            v = random.nextFloat() - 0.5f;
+
+        return spectrum;
+    }
+}
+
+// every vector kernel this machine can run, against the scalar one.
+class SpectralKernelsTests : public juce::UnitTest
+{
+public:
+    SpectralKernelsTests() : juce::UnitTest("SpectralKernels", "SilkGhost") {}
+
+    void runTest() override
+    {
+        const auto scalar = SpectralKernels::getMultiplyAccumulate(Instructions::scalar);
+
+        for (auto instructions : allInstructions)
+        {
+            if (instructions == Instructions::scalar || ! SpectralKernels::isAvailable(instructions))
+                continue;
+
+            beginTest(juce::String(SpectralKernels::getName(instructions)) + " matches scalar");
+
+            const auto kernel = SpectralKernels::getMultiplyAccumulate(instructions);
+            juce::Random random(1);
+
+            // every leftover a vector loop can have at each width, and real stage sizes (a power
+            // of two plus the Nyquist bin). the spectra start a float in, so nothing's aligned,
+            // and the accumulator already has something in it.
+            for (int numBins : { 1, 2, 3, 5, 7, 8, 9, 15, 16, 17, 31, 33, 129, 2049 })
+            {
+                const auto a = makeSpectrum(numBins + 1, random);
+                const auto b = makeSpectrum(numBins + 1, random);
+                auto expected = makeSpectrum(numBins + 1, random);
+                auto actual = expected;
+
+                for (int partition = 0; partition < 4; ++partition)
+                {
+                    const auto gain = 0.25f + 0.5f * (float) partition;
+                    scalar(expected.data() + 1, a.data() + 1, b.data() + 1, gain, numBins);
+                    kernel(actual.data() + 1, a.data() + 1, b.data() + 1, gain, numBins);
+                }
+
+                // FMA rounds once where scalar rounds twice, so the two can be a little way apart.
+                float error = 0.0f;
+                for (size_t i = 1; i < actual.size(); ++i)
+                    error = juce::jmax(error, std::abs(actual[i] - expected[i]));
+
+                expectLessThan(error, 1.0e-5f, juce::String(numBins) + " bins");
+                expectEquals(actual.front(), expected.front(), "wrote before the start");
+                expectEquals(actual[(size_t) numBins * 2 + 1], expected[(size_t) numBins * 2 + 1], "wrote past the end");
+            }
+        }
+    }
+};
+
+// a quick micro-benchmark, which only runs when asked for (see Main.cpp): every kernel this
+// machine supports over a few typical stage shapes, counting a complex multiply-accumulate as 8
+// flops.
+class SpectralKernelsBenchmark : public juce::UnitTest
+{
+public:
+    SpectralKernelsBenchmark() : juce::UnitTest("SpectralKernels benchmark", "SilkGhost benchmarks") {}
+
+    void runTest() override
+    {
+        beginTest("Throughput");
+
+        // a head-sized stage, a middle one, and the shape of a long tail's last stage.
+        const std::pair<int, int> shapes[] = { { 129, 8 }, { 2049, 8 }, { 8193, 100 } };
+
+        for (auto instructions : allInstructions)
+        {
+            if (! SpectralKernels::isAvailable(instructions))
+                continue;
+
+            juce::String report;
+            report << SpectralKernels::getName(instructions) << ":";
+
+            for (auto& shape : shapes)
+                report << "  " << shape.second << " x " << shape.first << " bins = "
+                       << juce::String(measureThroughput(instructions, shape.first, shape.second), 2) << " GFLOP/s";
+
+            logMessage(report);
+        }
+    }
+
+private:
+    // runs a kernel over numPartitions partitions of numBins bins (the shape of one stage's work)
+    // for roughly the given time, and returns the throughput in GFLOP/s.
+    static double measureThroughput(Instructions instructions, int numBins, int numPartitions, double seconds = 0.25)
+    {
+        const auto kernel = SpectralKernels::getMultiplyAccumulate(instructions);
+        const auto spectrumSize = (size_t) numBins * 2;
+
+        juce::Random random(1);
+        const auto inputs = makeSpectrum(numBins * numPartitions, random);
+        const auto partitions = makeSpectrum(numBins * numPartitions, random);
+        std::vector<float> accumulator(spectrumSize);
+
+        juce::int64 complexOperations = 0;
+        const auto start = juce::Time::getMillisecondCounterHiRes();
+        double elapsed = 0.0;
+
+        do
+        {
+            std::fill(accumulator.begin(), accumulator.end(), 0.0f);
+
+            for (int p = 0; p < numPartitions; ++p)
+                kernel(accumulator.data(), inputs.data() + (size_t) p * spectrumSize, partitions.data() + (size_t) p * spectrumSize, 1.0f, numBins);
+
+            complexOperations += (juce::int64) numBins * numPartitions;
+            elapsed = (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+        }
+        while (elapsed < seconds);
+
+        // keep the optimiser from throwing the whole thing away.
+        static volatile float sink;
+        sink = accumulator[0];
+
+        return (double) complexOperations * 8.0 / elapsed / 1.0e9;
+    }
+};
+
+static SpectralKernelsTests spectralKernelsTests;
+static SpectralKernelsBenchmark spectralKernelsBenchmark;